@@ -6,13 +6,35 @@
 #define __FVV__
 
 #include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <condition_variable>
+#include <coroutine>
 #include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
 #include <functional>
+#include <future>
+#include <istream>
+#include <limits>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <ostream>
+#include <semaphore>
 #include <sstream>
+#include <stop_token>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -24,6 +46,22 @@
 #define FVV_INLINE inline
 #endif
 
+#if __has_include(<unistd.h>)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define FVV_POSIX_IO 1
+#else
+#define FVV_POSIX_IO 0
+#endif
+
+#if FVV_POSIX_IO && defined(FVV_USE_IO_URING) && __has_include(<liburing.h>)
+#include <liburing.h>
+#define FVV_IO_URING 1
+#else
+#define FVV_IO_URING 0
+#endif
+
 class FVV
 {
 
@@ -41,6 +79,151 @@ public:
   static constexpr const vec<int> defaultInts = {};
   static constexpr const vec<double> defaultDoubles = {};
   static constexpr const vec<str> defaultStrings = {};
+  enum class MemoryPolicy : uint8_t
+  {
+    Shrink,
+    Reuse,
+    Compact,
+  };
+  struct Options
+  {
+    MemoryPolicy memory = MemoryPolicy::Compact;
+    unsigned threads = 1;
+    bool cache = false;
+    bool exact = false;
+    std::stop_token stop = {};
+    std::function<void(std::coroutine_handle<>)> executor = nullptr;
+  };
+  struct MemoryUsage
+  {
+    size_t keys = 0;
+    size_t values = 0;
+    size_t descs = 0;
+    size_t containers = 0;
+    size_t caches = 0;
+    FVV_INLINE size_t total(void) const
+    {
+      return keys + values + descs + containers + caches;
+    }
+  };
+  struct Diff
+  {
+    vec<str> added;
+    vec<str> removed;
+    vec<str> changed;
+    FVV_INLINE bool empty(void) const
+    {
+      return added.empty() && removed.empty() && changed.empty();
+    }
+  };
+  template <typename T>
+  class Task
+  {
+  public:
+    struct promise_type
+    {
+      std::optional<T> value;
+      std::exception_ptr error;
+      std::coroutine_handle<> continuation = std::noop_coroutine();
+      FVV_INLINE Task get_return_object(void)
+      {
+        return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+      }
+      FVV_INLINE std::suspend_always initial_suspend(void) noexcept
+      {
+        return {};
+      }
+      FVV_INLINE auto final_suspend(void) noexcept
+      {
+        struct Final
+        {
+          FVV_INLINE bool await_ready(void) noexcept { return false; }
+          FVV_INLINE std::coroutine_handle<>
+          await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+          {
+            return handle.promise().continuation;
+          }
+          FVV_INLINE void await_resume(void) noexcept {}
+        };
+        return Final{};
+      }
+      FVV_INLINE void return_value(T result) { value = std::move(result); }
+      FVV_INLINE void unhandled_exception(void)
+      {
+        error = std::current_exception();
+      }
+    };
+    FVV_INLINE Task(Task &&other) noexcept
+        : _handle(std::exchange(other._handle, nullptr))
+    {
+    }
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+    FVV_INLINE ~Task(void)
+    {
+      if (_handle)
+        _handle.destroy();
+    }
+    FVV_INLINE bool await_ready(void) const noexcept { return false; }
+    FVV_INLINE std::coroutine_handle<>
+    await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+      _handle.promise().continuation = awaiting;
+      return _handle;
+    }
+    FVV_INLINE T await_resume(void)
+    {
+      if (_handle.promise().error)
+        std::rethrow_exception(_handle.promise().error);
+      return std::move(*_handle.promise().value);
+    }
+    FVV_INLINE T get(void)
+    {
+      struct Detached
+      {
+        struct promise_type
+        {
+          FVV_INLINE Detached get_return_object(void) { return {}; }
+          FVV_INLINE std::suspend_never initial_suspend(void) noexcept
+          {
+            return {};
+          }
+          FVV_INLINE std::suspend_never final_suspend(void) noexcept
+          {
+            return {};
+          }
+          FVV_INLINE void return_void(void) {}
+          FVV_INLINE void unhandled_exception(void) {}
+        };
+      };
+      struct Start
+      {
+        Task &task;
+        FVV_INLINE bool await_ready(void) const noexcept { return false; }
+        FVV_INLINE std::coroutine_handle<>
+        await_suspend(std::coroutine_handle<> awaiting) noexcept
+        {
+          return task.await_suspend(awaiting);
+        }
+        FVV_INLINE void await_resume(void) const noexcept {}
+      };
+      std::binary_semaphore done(0);
+      [](Task &task, std::binary_semaphore &done) -> Detached
+      {
+        co_await Start{task};
+        done.release();
+      }(*this, done);
+      done.acquire();
+      return await_resume();
+    }
+
+  private:
+    std::coroutine_handle<promise_type> _handle;
+    FVV_INLINE explicit Task(std::coroutine_handle<promise_type> handle)
+        : _handle(handle)
+    {
+    }
+  };
   struct FVVV
   {
     using FVVVT = std::variant<std::monostate, bool, int, double, str,
@@ -59,9 +242,50 @@ public:
     FVV_INLINE FVVV(const vec<int> &v) : value(v) {}
     FVV_INLINE FVVV(const vec<double> &v) : value(v) {}
     FVV_INLINE FVVV(const vec<str> &v) : value(v) {}
+    FVV_INLINE FVVV(const FVVV &other)
+        : value(other.value), children(other.children), desc(other.desc),
+          link(other.link), linkName(other.linkName),
+          _hash{other._hash[0], other._hash[1]}, _hashed(other._hashed)
+    {
+      _adopt();
+    }
+    FVV_INLINE FVVV(FVVV &&other) noexcept
+        : value(std::move(other.value)), children(std::move(other.children)),
+          desc(std::move(other.desc)), link(other.link),
+          linkName(std::move(other.linkName)),
+          _hash{other._hash[0], other._hash[1]}, _hashed(other._hashed),
+          _printCache(std::move(other._printCache))
+    {
+      _adopt();
+      other._touch();
+    }
+    FVV_INLINE FVVV &operator=(const FVVV &other)
+    {
+      if (this != &other)
+        *this = FVVV(other);
+      return *this;
+    }
+    FVV_INLINE FVVV &operator=(FVVV &&other) noexcept
+    {
+      if (this == &other)
+        return *this;
+      value = std::move(other.value);
+      children = std::move(other.children);
+      desc = std::move(other.desc);
+      link = other.link;
+      linkName = std::move(other.linkName);
+      _adopt();
+      _touch();
+      other._touch();
+      return *this;
+    }
     FVV_INLINE FVVV &operator[](const strv &key)
     {
-      return children[key.data()];
+      auto [it, inserted] = children.try_emplace(key.data());
+      it->second._parent = this;
+      if (inserted)
+        _touch();
+      return it->second;
     }
     FVV_INLINE bool asBool(void) const
     {
@@ -143,271 +367,431 @@ public:
     }
     FVV_INLINE bool hasDesc(void) const { return !desc.empty(); }
     FVV_INLINE const str &getDesc(void) const { return desc; }
-    FVV_INLINE void setDesc(const strv &newDesc)
+    FVV_INLINE void setDesc(const strv &newDesc,
+                            MemoryPolicy memory = MemoryPolicy::Shrink)
     {
       desc = newDesc;
-      _shrink(&desc);
+      _shrinkBy(memory, &desc);
+      _touch();
+    }
+    FVV_INLINE void delDesc(void)
+    {
+      _clearAndShrink(&desc);
+      _touch();
     }
-    FVV_INLINE void delDesc(void) { _clearAndShrink(&desc); }
     FVV_INLINE bool isLink(void) const { return link != nullptr; }
     FVV_INLINE FVVV &getLink(void) const { return *link; }
     FVV_INLINE const str &getLinkName(void) const { return linkName; }
-    FVV_INLINE void setLink(FVVV *newLink) { link = newLink; }
-    FVV_INLINE void setLinkName(const strv &newlinkName)
+    FVV_INLINE void setLink(FVVV *newLink)
+    {
+      link = newLink;
+      _touch();
+    }
+    FVV_INLINE void setLinkName(const strv &newlinkName,
+                                MemoryPolicy memory = MemoryPolicy::Shrink)
     {
       linkName = newlinkName;
-      _shrink(&linkName);
+      _shrinkBy(memory, &linkName);
+      _touch();
     }
     FVV_INLINE void delLink(void)
     {
       link = nullptr;
       _clearAndShrink(&linkName);
+      _touch();
     }
     FVV_INLINE void link2Real(void)
     {
       value = link->value;
       link = nullptr;
       _clearAndShrink(&linkName);
+      _touch();
+    }
+    FVV_INLINE void touch(void)
+    {
+      _adopt();
+      _touch();
+    }
+    FVV_INLINE uint64_t hash(bool withDesc = true) const
+    {
+      std::function<void(const FVVV *)> hashFunc;
+      hashFunc = [&hashFunc](const FVVV *node)
+      {
+        if (node->_hashed)
+          return;
+        uint64_t self = _hashMix(_fnvBasis, node->value.index());
+        std::visit(
+            [&self](const auto &v)
+            {
+              using T = std::decay_t<decltype(v)>;
+              if constexpr (std::is_same_v<T, std::monostate>)
+                return;
+              else if constexpr (std::is_same_v<T, str>)
+                self = _hashString(self, v);
+              else if constexpr (std::is_same_v<T, vec<str>>)
+              {
+                self = _hashMix(self, v.size());
+                for (const str &s : v)
+                  self = _hashString(self, s);
+              }
+              else if constexpr (std::is_arithmetic_v<T>)
+                self = _hashValue(self, v);
+              else
+              {
+                self = _hashMix(self, v.size());
+                for (const auto &item : v)
+                  self = _hashValue(
+                      self, static_cast<typename T::value_type>(item));
+              }
+            },
+            node->value);
+        self = _hashString(self, node->linkName);
+        node->_hash[0] = _hashString(self, node->desc);
+        node->_hash[1] = self;
+        for (const auto &[key, child] : node->children)
+        {
+          if (_isBlank(child))
+            continue;
+          hashFunc(&child);
+          const uint64_t keyHash = _hashString(_fnvBasis, key);
+          node->_hash[0] =
+              _hashMix(_hashMix(node->_hash[0], keyHash), child._hash[0]);
+          node->_hash[1] =
+              _hashMix(_hashMix(node->_hash[1], keyHash), child._hash[1]);
+        }
+        node->_hashed = true;
+      };
+      hashFunc(this);
+      return _hash[withDesc ? 0 : 1];
+    }
+    static FVV_INLINE Diff diff(const FVVV &a, const FVVV &b,
+                                bool withDesc = true)
+    {
+      Diff result;
+      std::function<void(const str &, const FVVV *, const FVVV *)> diffFunc;
+      diffFunc = [&](const str &path, const FVVV *oldNode, const FVVV *newNode)
+      {
+        if (oldNode->hash(withDesc) == newNode->hash(withDesc))
+          return;
+        if (oldNode->value != newNode->value ||
+            oldNode->linkName != newNode->linkName ||
+            (withDesc && oldNode->desc != newNode->desc))
+          result.changed.push_back(path);
+        const str prefix = path.empty() ? path : path + str(".");
+        auto oldIt = oldNode->children.begin();
+        auto newIt = newNode->children.begin();
+        while (oldIt != oldNode->children.end() ||
+               newIt != newNode->children.end())
+        {
+          if (newIt == newNode->children.end() ||
+              (oldIt != oldNode->children.end() && oldIt->first < newIt->first))
+          {
+            if (!_isBlank(oldIt->second))
+              result.removed.push_back(prefix + oldIt->first);
+            ++oldIt;
+          }
+          else if (oldIt == oldNode->children.end() ||
+                   newIt->first < oldIt->first)
+          {
+            if (!_isBlank(newIt->second))
+              result.added.push_back(prefix + newIt->first);
+            ++newIt;
+          }
+          else
+          {
+            if (_isBlank(oldIt->second) && !_isBlank(newIt->second))
+              result.added.push_back(prefix + newIt->first);
+            else if (!_isBlank(oldIt->second) && _isBlank(newIt->second))
+              result.removed.push_back(prefix + oldIt->first);
+            else if (!_isBlank(oldIt->second))
+              diffFunc(prefix + oldIt->first, &oldIt->second, &newIt->second);
+            ++oldIt;
+            ++newIt;
+          }
+        }
+      };
+      diffFunc(str(""), &a, &b);
+      return result;
+    }
+    FVV_INLINE void compact(void)
+    {
+      std::function<void(FVVV *)> compactFunc;
+      compactFunc = [&compactFunc](FVVV *node)
+      {
+        _shrink(&node->desc, &node->linkName);
+        std::visit(
+            [](auto &v)
+            {
+              if constexpr (requires { v.shrink_to_fit(); })
+                v.shrink_to_fit();
+              if constexpr (std::is_same_v<std::decay_t<decltype(v)>, vec<str>>)
+                for (str &s : v)
+                  s.shrink_to_fit();
+            },
+            node->value);
+        for (auto &[key, child] : node->children)
+          compactFunc(&child);
+      };
+      compactFunc(this);
+    }
+    FVV_INLINE MemoryUsage memoryUsage(void) const
+    {
+      MemoryUsage result;
+      std::function<void(const FVVV *)> usageFunc;
+      usageFunc = [&result, &usageFunc](const FVVV *node)
+      {
+        result.descs += _heapBytes(node->desc);
+        result.values += _heapBytes(node->linkName);
+        if (node->_printCache)
+        {
+          result.caches += sizeof(_PrintCache);
+          for (const auto &[key, text] : *node->_printCache)
+            result.caches += sizeof(_PrintCache::value_type) +
+                             4 * sizeof(void *) + _heapBytes(text);
+        }
+        std::visit(
+            [&result](const auto &v)
+            {
+              using T = std::decay_t<decltype(v)>;
+              if constexpr (std::is_same_v<T, str>)
+                result.values += _heapBytes(v);
+              else if constexpr (std::is_same_v<T, vec<bool>>)
+                result.values += (v.capacity() + CHAR_BIT - 1) / CHAR_BIT;
+              else if constexpr (std::is_same_v<T, vec<str>>)
+              {
+                result.values += v.capacity() * sizeof(str);
+                for (const str &s : v)
+                  result.values += _heapBytes(s);
+              }
+              else if constexpr (requires { v.capacity(); })
+                result.values += v.capacity() * sizeof(typename T::value_type);
+            },
+            node->value);
+        for (const auto &[key, child] : node->children)
+        {
+          result.keys += _heapBytes(key);
+          result.containers +=
+              sizeof(std::pair<const str, FVVV>) + 4 * sizeof(void *);
+          usageFunc(&child);
+        }
+      };
+      usageFunc(this);
+      return result;
     }
     FVV_INLINE str print(const strv &type = "common") const
+    {
+      return print(type, Options());
+    }
+    FVV_INLINE str print(const strv &type, const Options &options) const
     {
       str result;
+      const bool isMin = type == strv("min");
       result += str("{");
-      if (type != strv("min"))
+      if (!isMin)
         result += str("\n");
-      std::function<void(const str &, const FVVV *, int)> printFunc;
-      printFunc = [&](const str &path, const FVVV *node, int indentLevel)
+      const _PrintMode mode = isMin                   ? _PrintMode::Min
+                              : type == strv("nodesc") ? _PrintMode::NoDesc
+                              : type == strv("bigvec") ? _PrintMode::BigVec
+                                                       : _PrintMode::Common;
+      auto headFunc = [&](str &out, const str &path, int indentLevel)
       {
-        str indent(indentLevel * 2, ' ');
-        if (!node->children.empty() && !path.empty())
+        if (!isMin)
+          out += str(indentLevel * 2, ' ');
+        out += path;
+      };
+      auto tailFunc = [&](str &out, const FVVV *node, int indentLevel,
+                          bool isGroup)
+      {
+        if (isGroup)
         {
-          if (type == strv("min"))
-            result += path + str("={");
-          else
-            result += indent + path + str(" = {\n");
+          if (!isMin)
+            out += str(indentLevel * 2, ' ');
+          out += str("}");
         }
-        if (node->children.empty() && node->isNotEmpty())
+        if (!node->getDesc().empty() && !isMin && type != strv("nodesc"))
+          _printDesc(out, node->getDesc());
+        out += str(";");
+        if (!isMin)
+          out += str("\n");
+      };
+      std::function<void(str &, const str &, const FVVV *, int)> printFunc;
+      printFunc = [&](str &out, const str &path, const FVVV *node,
+                      int indentLevel)
+      {
+        if (node->children.empty() && node->isEmpty())
+          return;
+        headFunc(out, path, indentLevel);
+        const _PrintCache::key_type key(mode, options.exact, indentLevel);
+        const bool cached = options.cache && !node->children.empty();
+        if (cached && node->_printCache)
         {
-          if (type == strv("min"))
-            result += path + str("=");
-          else
-            result += indent + path + str(" = ");
-          if (node->isLink())
+          auto it = node->_printCache->find(key);
+          if (it != node->_printCache->end())
           {
-            result += node->getLinkName();
+            out += it->second;
+            return;
           }
-          else if (node->isType<str>())
+        }
+        const size_t from = out.size();
+        if (!node->children.empty())
+        {
+          out += isMin ? str("={") : str(" = {\n");
+          for (const auto &[childKey, child] : node->children)
+            printFunc(out, childKey, &child, indentLevel + 1);
+        }
+        else
+        {
+          out += isMin ? str("=") : str(" = ");
+          _printValue(out, *node, indentLevel, type, options.exact);
+        }
+        tailFunc(out, node, indentLevel, !node->children.empty());
+        if (cached)
+        {
+          if (!node->_printCache)
+            node->_printCache = std::make_unique<_PrintCache>();
+          node->_printCache->emplace(key, out.substr(from));
+        }
+      };
+      const size_t threads =
+          std::min<size_t>(options.threads,
+                           std::max(1u, std::thread::hardware_concurrency()));
+      if (threads <= 1 || children.empty())
+        for (const auto &[key, child] : children)
+          printFunc(result, key, &child, 1);
+      else
+      {
+        struct Piece
+        {
+          str text;
+          const str *path = nullptr;
+          const FVVV *node = nullptr;
+          int indentLevel = 0;
+        };
+        vec<Piece> pieces;
+        for (const auto &[key, child] : children)
+          pieces.push_back(Piece{str(), &key, &child, 1});
+        while (true)
+        {
+          size_t nodes = 0, widest = pieces.size();
+          for (size_t i = 0; i < pieces.size(); ++i)
           {
-            result += str("\"");
-            str tmpStr = node->as<str>().value();
-            _utf8ForEach(
-                tmpStr, tmpStr.size(),
-                [&result]([[maybe_unused]] const size_t &index,
-                          const strv &index_char,
-                          [[maybe_unused]] const uint8_t &char_size) -> bool
-                {
-                  if (index_char == str("\""))
-                    result += str("\\");
-                  result += index_char;
-                  return false;
-                });
-            result += str("\"");
-          }
-          else if (node->isType<bool>())
-            result += node->as<bool>().value() ? str("true") : str("false");
-          else if (node->isType<int>())
-            result += std::to_string(node->as<int>().value());
-          else if (node->isType<double>())
-            result += std::to_string(node->as<double>().value());
-          else if (node->isType<vec<str>>())
-          {
-            result += str("[");
-            str vecIndent((indentLevel + 1) * 2, ' ');
-            if (type == strv("bigvec"))
-              result += str("\n");
-            const vec<str> tmp = node->as<vec<str>>().value();
-            for (const str &value : tmp)
-            {
-              if (type == strv("bigvec"))
-                result += vecIndent;
-              result += str("\"");
-              _utf8ForEach(
-                  value, value.size(),
-                  [&result]([[maybe_unused]] const size_t &index,
-                            const strv &index_char,
-                            [[maybe_unused]] const uint8_t &char_size) -> bool
-                  {
-                    if (index_char == str("\""))
-                      result += str("\\");
-                    result += index_char;
-                    return false;
-                  });
-              result += str("\",");
-              if (type == strv("bigvec"))
-                result += str("\n");
-              else if (type != strv("min"))
-                result += str(" ");
-            }
-            if (type != strv("bigvec"))
-            {
-              result.pop_back();
-              if (type != strv("min"))
-                result.pop_back();
-            }
-            else if (type == strv("bigvec"))
-              result += indent;
-            result += str("]");
-          }
-          else if (node->isType<vec<bool>>())
-          {
-            result += str("[");
-            str vecIndent((indentLevel + 1) * 2, ' ');
-            if (type == strv("bigvec"))
-              result += str("\n");
-            const vec<bool> tmp = node->as<vec<bool>>().value();
-            for (const int &value : tmp)
-            {
-              if (type == strv("bigvec"))
-                result += vecIndent;
-              result += value ? str("true") : str("false") + str(",");
-              if (type == strv("bigvec"))
-                result += str("\n");
-              else if (type != strv("min"))
-                result += str(" ");
-            }
-            if (type != strv("bigvec"))
-            {
-              result.pop_back();
-              if (type != strv("min"))
-                result.pop_back();
-            }
-            else if (type == strv("bigvec"))
-              result += indent;
-            result += str("]");
-          }
-          else if (node->isType<vec<int>>())
-          {
-            result += str("[");
-            str vecIndent((indentLevel + 1) * 2, ' ');
-            if (type == strv("bigvec"))
-              result += str("\n");
-            const vec<int> tmp = node->as<vec<int>>().value();
-            for (const int &value : tmp)
-            {
-              if (type == strv("bigvec"))
-                result += vecIndent;
-              result += std::to_string(value) + str(",");
-              if (type == strv("bigvec"))
-                result += str("\n");
-              else if (type != strv("min"))
-                result += str(" ");
-            }
-            if (type != strv("bigvec"))
-            {
-              result.pop_back();
-              if (type != strv("min"))
-                result.pop_back();
-            }
-            else if (type == strv("bigvec"))
-              result += indent;
-            result += str("]");
-          }
-          else if (node->isType<vec<double>>())
-          {
-            result += str("[");
-            str vecIndent((indentLevel + 1) * 2, ' ');
-            if (type == strv("bigvec"))
-              result += str("\n");
-            const vec<double> tmp = node->as<vec<double>>().value();
-            for (const double &value : tmp)
-            {
-              if (type == strv("bigvec"))
-                result += vecIndent;
-              result += std::to_string(value) + str(",");
-              if (type == strv("bigvec"))
-                result += str("\n");
-              else if (type != strv("min"))
-                result += str(" ");
-            }
-            if (type != strv("bigvec"))
-            {
-              result.pop_back();
-              if (type != strv("min"))
-                result.pop_back();
-            }
-            else if (type == strv("bigvec"))
-              result += indent;
-            result += str("]");
-          }
-          if (!node->getDesc().empty() && type != strv("min") &&
-              type != strv("nodesc"))
-          {
-            result += str(" <");
-            str tmpStr = node->getDesc();
-            _utf8ForEach(
-                tmpStr, tmpStr.size(),
-                [&result]([[maybe_unused]] const size_t &index,
-                          const strv &index_char,
-                          [[maybe_unused]] const uint8_t &char_size) -> bool
-                {
-                  if (index_char == str(">"))
-                    result += str("\\");
-                  result += index_char;
-                  return false;
-                });
-            result += str(">");
+            const FVVV *node = pieces[i].node;
+            if (node == nullptr)
+              continue;
+            ++nodes;
+            if (!node->children.empty() &&
+                (!options.cache || !node->_printCache ||
+                 !node->_printCache->count(
+                     {mode, options.exact, pieces[i].indentLevel})) &&
+                (widest == pieces.size() ||
+                 node->children.size() >
+                     pieces[widest].node->children.size()))
+              widest = i;
           }
-          result += str(";");
-          if (type != strv("min"))
-            result += str("\n");
+          if (nodes >= threads || widest == pieces.size())
+            break;
+          const Piece group = pieces[widest];
+          vec<Piece> expanded;
+          expanded.push_back(Piece{str(), nullptr, nullptr, 0});
+          headFunc(expanded.back().text, *group.path, group.indentLevel);
+          expanded.back().text += isMin ? str("={") : str(" = {\n");
+          for (const auto &[key, child] : group.node->children)
+            expanded.push_back(
+                Piece{str(), &key, &child, group.indentLevel + 1});
+          expanded.push_back(Piece{str(), nullptr, nullptr, 0});
+          tailFunc(expanded.back().text, group.node, group.indentLevel, true);
+          pieces.erase(pieces.begin() + widest);
+          pieces.insert(pieces.begin() + widest,
+                        std::make_move_iterator(expanded.begin()),
+                        std::make_move_iterator(expanded.end()));
         }
-        else
-          for (const auto &[key, child] : node->children)
-            printFunc(key, &child, indentLevel + 1);
-        if (!node->children.empty() && !path.empty())
+        const size_t chunks = std::min(pieces.size(), threads * 4);
+        const size_t chunk = (pieces.size() + chunks - 1) / chunks;
+        struct Progress
         {
-          if (type == strv("min"))
-            result += str("}");
-          else
-            result += indent + str("}");
-          if (!node->getDesc().empty() && type != strv("min") &&
-              type != strv("nodesc"))
-          {
-            result += str(" <");
-            str tmpStr = node->getDesc();
-            _utf8ForEach(
-                tmpStr, tmpStr.size(),
-                [&result]([[maybe_unused]] const size_t &index,
-                          const strv &index_char,
-                          [[maybe_unused]] const uint8_t &char_size) -> bool
-                {
-                  if (index_char == str(">"))
-                    result += str("\\");
-                  result += index_char;
-                  return false;
-                });
-            result += str(">");
+          std::atomic<size_t> next = 0;
+          size_t count = 0;
+          size_t done = 0;
+          std::mutex mutex;
+          std::condition_variable cv;
+        };
+        auto progress = std::make_shared<Progress>();
+        progress->count = (pieces.size() + chunk - 1) / chunk;
+        auto work = [progress, &pieces, &printFunc, chunk](void)
+        {
+          for (size_t index; (index = progress->next++) < progress->count;)
+          {
+            const size_t end = std::min((index + 1) * chunk, pieces.size());
+            for (size_t i = index * chunk; i < end; ++i)
+              if (pieces[i].node != nullptr)
+                printFunc(pieces[i].text, *pieces[i].path, pieces[i].node,
+                          pieces[i].indentLevel);
+            std::lock_guard<std::mutex> lock(progress->mutex);
+            if (++progress->done == progress->count)
+              progress->cv.notify_all();
           }
-          result += str(";");
-          if (type != strv("min"))
-            result += str("\n");
+        };
+        for (size_t i = 1; i < std::min(threads, progress->count); ++i)
+          _pool().post(work);
+        work();
+        {
+          std::unique_lock<std::mutex> lock(progress->mutex);
+          progress->cv.wait(lock, [&progress](void)
+                            { return progress->done == progress->count; });
         }
-      };
-      printFunc(str(""), this, 0);
+        for (const Piece &piece : pieces)
+          result += piece.text;
+      }
       result += str("}");
-      _shrink(&result);
+      if (options.memory != MemoryPolicy::Reuse)
+        _shrink(&result);
       return result;
     }
+
+  private:
+    FVVV *_parent = nullptr;
+    mutable uint64_t _hash[2] = {0, 0};
+    mutable bool _hashed = false;
+    enum class _PrintMode : uint8_t
+    {
+      Common,
+      Min,
+      NoDesc,
+      BigVec,
+    };
+    using _PrintCache = std::map<std::tuple<_PrintMode, bool, int>, str>;
+    mutable std::unique_ptr<_PrintCache> _printCache;
+    FVV_INLINE void _adopt(void)
+    {
+      for (auto &[key, child] : children)
+        child._parent = this;
+    }
+    FVV_INLINE void _touch(void)
+    {
+      FVVV *node = this;
+      do
+      {
+        node->_hashed = false;
+        node->_printCache.reset();
+        node = node->_parent;
+      } while (node != nullptr && (node->_hashed || node->_printCache));
+    }
   };
   class Parser
   {
   public:
     static FVV_INLINE void ReadString(str txt, FVVV &targetFvv)
     {
+      ReadString(std::move(txt), targetFvv, Options());
+    }
+    static FVV_INLINE void ReadString(str txt, FVVV &targetFvv,
+                                      const Options &options)
+    {
+      const MemoryPolicy memory = options.memory;
       if (txt.size() >= 3 && static_cast<unsigned char>(txt[0]) == _bom[0] &&
           static_cast<unsigned char>(txt[1]) == _bom[1] &&
           static_cast<unsigned char>(txt[2]) == _bom[2])
-        txt = txt.substr(3);
+        txt.erase(0, 3);
       size_t start = str::npos;
       size_t end = str::npos;
       for (size_t i = 0; i < txt.size(); ++i)
@@ -418,32 +802,30 @@ public:
         }
       if (start == str::npos)
         return;
-      for (size_t i = txt.size(); i-- > 0;)
-        if (txt[i] == '}' && (i == 0 || txt[i - 1] != '\\'))
-        {
-          end = i;
-          break;
-        }
+      end = _rootEnd(txt);
       if (end == str::npos || end <= start)
         return;
-      txt = txt.substr(start + 1, end - start - 1);
+      txt.erase(end);
+      txt.erase(0, start + 1);
       start = txt.find_first_not_of(" \t\r\n");
-      txt = start == str::npos ? "" : txt.substr(start);
+      txt.erase(0, start);
       if (txt.empty())
         return;
-      _shrink(&txt);
+      _shrinkBy(memory, &txt);
       str desc, index_desc, value, valueName;
       vec<str> groupNames, valueNames, values;
       vec<vec<str>> lastGroupNames;
       bool inValue = false, inDesc = false, inStr = false, isRealChar = false,
            isStr = false, isList = false;
-      size_t inGroup = 0;
+      size_t inGroup = 0, steps = 0;
       uint8_t last_char_size = 0;
       _utf8ForEach(
           txt, txt.size(),
           [&](const size_t &index, const strv &index_char,
               const uint8_t &char_size) -> bool
           {
+            if ((++steps & 0xFFF) == 0 && options.stop.stop_requested())
+              return true;
             FVVV *index_key = &targetFvv;
             isRealChar = index >= 1
                              ? (last_char_size == 1
@@ -458,7 +840,7 @@ public:
                 if (index_char == str(">") && !isRealChar)
                 {
                   index_desc.pop_back();
-                  _shrink(&index_desc);
+                  _shrinkBy(memory, &index_desc);
                 }
                 if (inValue || inGroup > 0)
                   index_desc += index_char;
@@ -466,9 +848,9 @@ public:
               }
               else if (index_char == str(">") && isRealChar)
               {
-                desc = index_desc;
-                _clearAndShrink(&index_desc);
-                _shrink(&desc);
+                std::swap(desc, index_desc);
+                _clearBy(memory, &index_desc);
+                _shrinkBy(memory, &desc);
                 inDesc = false;
                 return false;
               }
@@ -499,7 +881,7 @@ public:
                   else
                   {
                     value.pop_back();
-                    _shrink(&value);
+                    _shrinkBy(memory, &value);
                     value += index_char;
                     return false;
                   }
@@ -534,7 +916,7 @@ public:
                       return false;
                   }
                   values.push_back(value);
-                  _clearAndShrink(&value);
+                  _clearBy(memory, &value);
                   return false;
                 }
                 else if (index_char == str("{"))
@@ -542,7 +924,7 @@ public:
                   groupNames.insert(groupNames.end(), valueNames.begin(),
                                     valueNames.end());
                   lastGroupNames.push_back(valueNames);
-                  _clearAndShrink(&valueNames);
+                  _clearBy(memory, &valueNames);
                   ++inGroup;
                   inValue = false;
                   return false;
@@ -605,35 +987,15 @@ public:
                           (*index_key)[key] = FVVV(std::stod(value));
                         else
                         {
-                          vec<str> tmpName = _split(value, '.');
-                          FVVV *tmpValue = index_key;
-                          for (size_t i = 0; i < tmpName.size(); ++i)
-                          {
-                            if (tmpValue->children.find(tmpName[i]) ==
-                                tmpValue->children.end())
-                              continue;
-                            tmpValue = &(*tmpValue)[tmpName[i]];
-                          }
-                          if ((*tmpValue).isNotEmpty())
+                          FVVV *tmpValue =
+                              _resolveLink(index_key, &targetFvv, value);
+                          if (tmpValue != nullptr)
                             (*index_key)[key].setLink(tmpValue);
-                          else
-                          {
-                            tmpValue = &targetFvv;
-                            for (size_t i = 0; i < tmpName.size(); ++i)
-                            {
-                              if (tmpValue->children.find(tmpName[i]) ==
-                                  tmpValue->children.end())
-                                continue;
-                              tmpValue = &(*tmpValue)[tmpName[i]];
-                            }
-                            if ((*tmpValue).isNotEmpty())
-                              (*index_key)[key].setLink(tmpValue);
-                          }
-                          (*index_key)[key].setLinkName(value);
+                          (*index_key)[key].setLinkName(value, memory);
                         }
                       }
-                      (*index_key)[key].setDesc(desc);
-                      _clearAndShrink(&desc, &value, &values, &valueNames);
+                      (*index_key)[key].setDesc(desc, memory);
+                      _clearBy(memory, &desc, &value, &values, &valueNames);
                       isList = isStr = inValue = false;
                       continue;
                     }
@@ -653,7 +1015,7 @@ public:
               if (index_char == str("="))
               {
                 valueNames = _split(valueName, '.');
-                _clearAndShrink(&valueName);
+                _clearBy(memory, &valueName);
                 inValue = true;
                 return false;
               }
@@ -664,8 +1026,8 @@ public:
                   {
                     if (i == groupNames.size() - 1)
                     {
-                      (*index_key)[groupNames[i]].setDesc(desc);
-                      _clearAndShrink(&desc);
+                      (*index_key)[groupNames[i]].setDesc(desc, memory);
+                      _clearBy(memory, &desc);
                       break;
                     }
                     index_key = &(*index_key)[groupNames[i]];
@@ -673,7 +1035,7 @@ public:
                 for (const auto &_ : lastGroupNames.back())
                   groupNames.pop_back();
                 lastGroupNames.pop_back();
-                _shrink(&groupNames, &lastGroupNames);
+                _shrinkBy(memory, &groupNames, &lastGroupNames);
                 inGroup--;
                 return false;
               }
@@ -687,70 +1049,2046 @@ public:
             }
             return false;
           });
+      if (memory == MemoryPolicy::Compact && !options.stop.stop_requested())
+        targetFvv.compact();
     }
 
   private:
     static constexpr const unsigned char _bom[] = {0xEF, 0xBB, 0xBF};
-    static FVV_INLINE vec<str> _split(const str &path, char delimiter)
-    {
-      vec<str> result;
-      std::stringstream ss(path);
-      str item;
-      while (std::getline(ss, item, delimiter))
-        result.push_back(item);
-      return result;
-    }
   };
-  static FVV_INLINE bool _isInt(const strv &s)
+  class Scanner
   {
-    if (s.empty())
-      return false;
-    size_t start = 0;
-    if (s[0] == '-' || s[0] == '+')
+  public:
+    enum class TokenType : uint8_t
     {
-      if (s.size() == 1)
-        return false;
-      start = 1;
-    }
-    return std::all_of(s.begin() + start, s.end(), ::isdigit);
-  }
-  static FVV_INLINE bool _isDouble(const strv &s)
-  {
-    if (s.empty())
-      return false;
-    size_t start = 0;
-    bool hasDigit = false, hasDot = false;
-    if (s[0] == '-' || s[0] == '+')
+      Key,
+      Assign,
+      Value,
+      String,
+      ListBegin,
+      ListEnd,
+      Comma,
+      GroupBegin,
+      GroupEnd,
+      End,
+      Comment,
+    };
+    struct Token
     {
-      if (s.size() == 1)
-        return false;
-      start = 1;
-    }
-    for (size_t i = start; i < s.size(); ++i)
+      TokenType type = TokenType::Value;
+      str text = "";
+      size_t begin = 0;
+      size_t end = 0;
+    };
+    using Handler = std::function<bool(const Token &)>;
+    FVV_INLINE bool feed(const strv &chunk, const Handler &handler)
     {
-      char c = s[i];
-      if (std::isdigit(c))
-        hasDigit = true;
-      else if (c == '.')
+      for (size_t i = 0; i < chunk.size() && !_done; ++i, ++_offset)
       {
-        if (hasDot)
-          return false;
-        hasDot = true;
+        if (_state == State::String || _state == State::Comment)
+        {
+          size_t stop = chunk.find(_state == State::String ? '"' : '>', i);
+          stop = stop == strv::npos ? chunk.size() : stop;
+          if (stop > i)
+          {
+            _token.text.append(chunk.data() + i, stop - i);
+            _last = chunk[stop - 1];
+            _offset += stop - i;
+            i = stop;
+            if (i == chunk.size())
+              break;
+          }
+        }
+        const char c = chunk[i];
+        const bool isRealChar = _last != '\\';
+        _last = c;
+        switch (_state)
+        {
+        case State::Root:
+          if (c == '{' && isRealChar)
+            _state = State::Key;
+          break;
+        case State::Comment:
+          if (c != '>')
+            _token.text += c;
+          else if (!isRealChar)
+            _token.text.back() = c;
+          else
+          {
+            _token.end = _offset + 1;
+            _state = _resume;
+            _emit(handler, _token);
+          }
+          break;
+        case State::String:
+          if (c != '"')
+            _token.text += c;
+          else if (!isRealChar)
+            _token.text.back() = c;
+          else
+          {
+            _token.end = _offset + 1;
+            _state = State::Value;
+            _emit(handler, _token);
+          }
+          break;
+        case State::Key:
+        case State::Value:
+          if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+            break;
+          if (c == '<')
+          {
+            _resume = _state;
+            _state = State::Comment;
+            _token = Token{TokenType::Comment, str(""), _offset, _offset};
+          }
+          else if (_state == State::Key)
+            _key(c, handler);
+          else
+            _value(c, handler);
+          break;
+        }
       }
-      else
-        return false;
+      return !_done;
     }
-    return hasDigit;
-  }
+    FVV_INLINE bool done(void) const { return _done; }
+    FVV_INLINE size_t depth(void) const { return _depth; }
+    FVV_INLINE size_t offset(void) const { return _offset; }
 
-private:
-  template <typename T>
-  static FVV_INLINE void _shrink(T *container)
-  {
-    if (container)
-      container->shrink_to_fit();
-  }
-  template <typename T, typename... Args>
+  private:
+    enum class State : uint8_t
+    {
+      Root,
+      Key,
+      Value,
+      String,
+      Comment,
+    };
+    State _state = State::Root;
+    State _resume = State::Key;
+    size_t _offset = 0;
+    size_t _depth = 0;
+    bool _done = false;
+    char _last = 0;
+    Token _token;
+    Token _word;
+    FVV_INLINE void _emit(const Handler &handler, const Token &token)
+    {
+      if (!_done && handler(token))
+        _done = true;
+    }
+    FVV_INLINE void _emit(const Handler &handler, TokenType type)
+    {
+      _emit(handler, Token{type, str(""), _offset, _offset + 1});
+    }
+    FVV_INLINE void _flush(const Handler &handler)
+    {
+      if (_word.text.empty())
+        return;
+      _emit(handler, _word);
+      _word.text.clear();
+    }
+    FVV_INLINE void _append(char c, TokenType type)
+    {
+      if (_word.text.empty())
+        _word = Token{type, str(""), _offset, _offset};
+      _word.text += c;
+      _word.end = _offset + 1;
+    }
+    FVV_INLINE void _key(char c, const Handler &handler)
+    {
+      if (c == '=')
+      {
+        if (_word.text.empty())
+          _word = Token{TokenType::Key, str(""), _offset, _offset};
+        _emit(handler, _word);
+        _word.text.clear();
+        _emit(handler, TokenType::Assign);
+        _state = State::Value;
+      }
+      else if (c == '}')
+      {
+        _word.text.clear();
+        if (_depth == 0)
+          _done = true;
+        else
+        {
+          --_depth;
+          _emit(handler, TokenType::GroupEnd);
+        }
+      }
+      else if (c == ';')
+      {
+        _word.text.clear();
+        _emit(handler, TokenType::End);
+      }
+      else
+        _append(c, TokenType::Key);
+    }
+    FVV_INLINE void _value(char c, const Handler &handler)
+    {
+      if (c == '"')
+      {
+        _flush(handler);
+        _state = State::String;
+        _token = Token{TokenType::String, str(""), _offset, _offset};
+      }
+      else if (c == '[')
+      {
+        _flush(handler);
+        _emit(handler, TokenType::ListBegin);
+      }
+      else if (c == ']')
+      {
+        _flush(handler);
+        _emit(handler, TokenType::ListEnd);
+      }
+      else if (c == ',')
+      {
+        _flush(handler);
+        _emit(handler, TokenType::Comma);
+      }
+      else if (c == '{')
+      {
+        _flush(handler);
+        ++_depth;
+        _emit(handler, TokenType::GroupBegin);
+        _state = State::Key;
+      }
+      else if (c == ';')
+      {
+        _flush(handler);
+        _emit(handler, TokenType::End);
+        _state = State::Key;
+      }
+      else
+        _append(c, TokenType::Value);
+    }
+  };
+  class Document
+  {
+  public:
+    struct Span
+    {
+      size_t begin = str::npos;
+      size_t end = str::npos;
+      FVV_INLINE bool empty(void) const { return begin == str::npos; }
+    };
+    struct Entry
+    {
+      Span key;
+      Span value;
+      Span desc;
+    };
+    FVV_INLINE Document(void) = default;
+    FVV_INLINE Document(str txt) { load(std::move(txt)); }
+    FVV_INLINE void load(str txt)
+    {
+      _text = std::move(txt);
+      _path.clear();
+      _savedSize = 0;
+      _resized = false;
+      _dirty.clear();
+      _index();
+    }
+    FVV_INLINE bool open(const str &path)
+    {
+      std::ifstream file(path, std::ios::binary);
+      if (!file)
+        return false;
+      std::ostringstream ss;
+      ss << file.rdbuf();
+      load(ss.str());
+      _path = path;
+      _savedSize = _text.size();
+      return true;
+    }
+    FVV_INLINE bool save(void)
+    {
+      if (_path.empty())
+        return false;
+      if (_dirty.empty())
+        return true;
+      for (const Span &span : _dirty)
+        if (span.begin > span.end || span.end > _text.size())
+          return false;
+      std::fstream file(_path, std::ios::in | std::ios::out | std::ios::binary);
+      if (!file)
+        return false;
+      if (_text.size() == _savedSize && !_resized)
+        for (const Span &span : _dirty)
+        {
+          file.seekp(static_cast<std::streamoff>(span.begin));
+          file.write(_text.data() + span.begin,
+                     static_cast<std::streamsize>(span.end - span.begin));
+        }
+      else
+      {
+        size_t from = _text.size();
+        for (const Span &span : _dirty)
+          from = std::min(from, span.begin);
+        file.seekp(static_cast<std::streamoff>(from));
+        file.write(_text.data() + from,
+                   static_cast<std::streamsize>(_text.size() - from));
+      }
+      file.close();
+      if (!file)
+        return false;
+      std::error_code ec;
+      if (_text.size() < _savedSize)
+        std::filesystem::resize_file(_path, _text.size(), ec);
+      if (ec)
+        return false;
+      _savedSize = _text.size();
+      _resized = false;
+      _dirty.clear();
+      return true;
+    }
+    FVV_INLINE bool save(const str &path)
+    {
+      if (path == _path)
+        return save();
+      std::ofstream file(path, std::ios::binary | std::ios::trunc);
+      if (!file)
+        return false;
+      file.write(_text.data(), static_cast<std::streamsize>(_text.size()));
+      file.close();
+      if (!file)
+        return false;
+      _path = path;
+      _savedSize = _text.size();
+      _resized = false;
+      _dirty.clear();
+      return true;
+    }
+    FVV_INLINE const str &text(void) const { return _text; }
+    FVV_INLINE const std::map<str, Entry> &entries(void) const
+    {
+      return _entries;
+    }
+    FVV_INLINE const Entry *find(const strv &path) const
+    {
+      auto it = _entries.find(str(path));
+      return it == _entries.end() ? nullptr : &it->second;
+    }
+    FVV_INLINE FVVV tree(void) const { return tree(Options()); }
+    FVV_INLINE FVVV tree(const Options &options) const
+    {
+      FVVV result;
+      Parser::ReadString(_text, result, options);
+      return result;
+    }
+    FVV_INLINE bool set(const strv &path, const FVVV &newValue)
+    {
+      const Entry *entry = find(path);
+      if (entry == nullptr)
+        return false;
+      std::function<bool(const FVVV &)> exactFunc;
+      exactFunc = [&exactFunc](const FVVV &node)
+      {
+        if (node.isType<double>() &&
+            !_isExactDouble(std::get<double>(node.value)))
+          return false;
+        if (node.isType<vec<double>>())
+          for (double value : std::get<vec<double>>(node.value))
+            if (!_isExactDouble(value))
+              return false;
+        for (const auto &[key, child] : node.children)
+          if (!exactFunc(child))
+            return false;
+        return true;
+      };
+      if (!exactFunc(newValue))
+        return false;
+      Options options;
+      options.exact = true;
+      str rendered;
+      if (newValue.children.empty())
+        _printValue(rendered, newValue, 0, "common", true);
+      else
+        rendered = newValue.print("common", options);
+      if (rendered.empty())
+        return false;
+      const bool isGroup = _text[entry->value.begin] == '{';
+      _splice(entry->value, rendered);
+      if (isGroup || !newValue.children.empty())
+        _index();
+      return true;
+    }
+    FVV_INLINE bool setDesc(const strv &path, const strv &newDesc)
+    {
+      auto it = _entries.find(str(path));
+      if (it == _entries.end())
+        return false;
+      str rendered;
+      if (!newDesc.empty())
+      {
+        _printDesc(rendered, str(newDesc));
+        rendered.erase(0, 1);
+      }
+      if (!it->second.desc.empty())
+      {
+        Span desc = it->second.desc;
+        if (rendered.empty())
+          while (desc.begin > it->second.value.end &&
+                 (_text[desc.begin - 1] == ' ' ||
+                  _text[desc.begin - 1] == '\t' ||
+                  _text[desc.begin - 1] == '\r' ||
+                  _text[desc.begin - 1] == '\n'))
+            --desc.begin;
+        _splice(desc, rendered);
+        it->second.desc = rendered.empty()
+                              ? Span()
+                              : Span{desc.begin, desc.begin + rendered.size()};
+      }
+      else if (!rendered.empty())
+      {
+        const size_t at = it->second.value.end;
+        _splice(Span{at, at}, str(" ") + rendered);
+        it->second.desc = Span{at + 1, at + 1 + rendered.size()};
+      }
+      return true;
+    }
+
+  private:
+    str _text;
+    str _path;
+    size_t _savedSize = 0;
+    bool _resized = false;
+    vec<Span> _dirty;
+    std::map<str, Entry> _entries;
+    FVV_INLINE void _index(void)
+    {
+      _entries.clear();
+      vec<str> groups;
+      str current, closing;
+      Entry entry;
+      Span desc;
+      bool inValue = false;
+      const size_t end = _rootEnd(_text);
+      if (end == str::npos)
+        return;
+      Scanner scanner;
+      scanner.feed(
+          strv(_text).substr(0, end + 1),
+          [&](const Scanner::Token &token) -> bool
+          {
+            switch (token.type)
+            {
+            case Scanner::TokenType::Key:
+              current = groups.empty() ? token.text
+                                       : groups.back() + str(".") + token.text;
+              entry = Entry{Span{token.begin, token.end}, Span(), Span()};
+              closing.clear();
+              break;
+            case Scanner::TokenType::Assign:
+              inValue = true;
+              break;
+            case Scanner::TokenType::Comment:
+              desc = inValue || !groups.empty() || !closing.empty()
+                         ? Span{token.begin, token.end}
+                         : Span();
+              break;
+            case Scanner::TokenType::GroupBegin:
+              entry.value = Span{token.begin, token.end};
+              _entries[current] = entry;
+              groups.push_back(current);
+              inValue = false;
+              break;
+            case Scanner::TokenType::GroupEnd:
+              if (groups.empty())
+                break;
+              closing = groups.back();
+              groups.pop_back();
+              _entries[closing].value.end = token.end;
+              break;
+            case Scanner::TokenType::End:
+              if (inValue && !entry.value.empty())
+              {
+                entry.desc = desc;
+                _entries[current] = entry;
+              }
+              else if (!closing.empty() && !desc.empty())
+                _entries[closing].desc = desc;
+              if (inValue || !closing.empty())
+                desc = Span();
+              inValue = false;
+              closing.clear();
+              break;
+            default:
+              if (!inValue)
+                break;
+              if (entry.value.empty())
+                entry.value.begin = token.begin;
+              entry.value.end = token.end;
+              break;
+            }
+            return false;
+          });
+    }
+    FVV_INLINE void _splice(const Span span, const str &replacement)
+    {
+      const size_t oldSize = _text.size();
+      _text.replace(span.begin, span.end - span.begin, replacement);
+      const size_t newEnd = span.begin + replacement.size();
+      auto shift = [&span, newEnd](size_t &offset)
+      {
+        if (offset != str::npos && offset >= span.end && offset > span.begin)
+          offset = offset - span.end + newEnd;
+      };
+      for (auto &[path, entry] : _entries)
+        for (Span *item : {&entry.key, &entry.value, &entry.desc})
+        {
+          shift(item->begin);
+          shift(item->end);
+        }
+      for (Span &dirty : _dirty)
+      {
+        shift(dirty.begin);
+        shift(dirty.end);
+      }
+      if (newEnd != span.end)
+        _resized = true;
+      if (_text.size() != oldSize || !replacement.empty())
+        _dirty.push_back(Span{span.begin, newEnd});
+    }
+  };
+  class Json
+  {
+  public:
+    struct Options
+    {
+      str descSuffix = "";
+      bool expandLinks = false;
+      size_t linkLimit = 1 << 20;
+      size_t bufferSize = 1 << 16;
+    };
+    static FVV_INLINE bool FromFVV(std::istream &in, std::ostream &out)
+    {
+      return FromFVV(in, out, Options());
+    }
+    static FVV_INLINE bool FromFVV(std::istream &in, std::ostream &out,
+                                   const Options &options)
+    {
+      struct Frame
+      {
+        bool isList = false;
+        bool first = true;
+      };
+      _Writer writer(out, options.bufferSize);
+      vec<Frame> frames = {Frame()};
+      vec<str> keys, paths;
+      std::map<str, str> seen;
+      size_t seenBytes = 0;
+      str key, path, closing, desc, pending;
+      bool inValue = false, afterGroup = false, filled = false,
+           hasPending = false, ok = true;
+      auto fail = [&ok](void)
+      {
+        ok = false;
+        return true;
+      };
+      auto flushPending = [&](void)
+      {
+        if (hasPending)
+          _jsonString(writer, pending);
+        hasPending = false;
+      };
+      auto separate = [&writer, &frames](void)
+      {
+        if (!frames.back().first)
+          writer.write(",");
+        frames.back().first = false;
+      };
+      auto literal = [&](const str &text)
+      {
+        if (text == strv("true") || text == strv("false"))
+          writer.write(text);
+        else if (_isInt(text) || _isDouble(text))
+          writer.write(_jsonNumber(text));
+        else
+        {
+          if (options.expandLinks)
+          {
+            const str scope = paths.empty() ? str("") : paths.back() + ".";
+            auto it = seen.find(scope + text);
+            if (it == seen.end())
+              it = seen.find(text);
+            if (it != seen.end())
+            {
+              writer.write(it->second);
+              return;
+            }
+          }
+          writer.write("{\"$ref\":");
+          _jsonString(writer, text);
+          writer.write("}");
+        }
+      };
+      writer.write("{");
+      Scanner scanner;
+      auto handler = [&](const Scanner::Token &token) -> bool
+      {
+        switch (token.type)
+        {
+        case Scanner::TokenType::Key:
+          key = token.text;
+          if (options.expandLinks)
+            path = paths.empty() ? key : paths.back() + str(".") + key;
+          desc.clear();
+          afterGroup = false;
+          break;
+        case Scanner::TokenType::Assign:
+          separate();
+          _jsonString(writer, key);
+          writer.write(":");
+          inValue = true;
+          filled = false;
+          writer.capture(options.expandLinks,
+                         options.linkLimit - std::min(options.linkLimit,
+                                                      seenBytes + path.size()));
+          break;
+        case Scanner::TokenType::Value:
+          if (!inValue)
+            break;
+          if (filled)
+            return fail();
+          if (frames.back().isList)
+            separate();
+          literal(token.text);
+          filled = true;
+          break;
+        case Scanner::TokenType::String:
+          if (!inValue)
+            break;
+          if (hasPending)
+          {
+            pending += token.text;
+            break;
+          }
+          if (filled)
+            return fail();
+          if (frames.back().isList)
+            separate();
+          pending = token.text;
+          hasPending = filled = true;
+          break;
+        case Scanner::TokenType::Comma:
+          if (!inValue)
+            break;
+          flushPending();
+          if (!frames.back().isList || !filled)
+            return fail();
+          filled = false;
+          break;
+        case Scanner::TokenType::ListBegin:
+          if (!inValue)
+            break;
+          if (filled || frames.back().isList)
+            return fail();
+          writer.write("[");
+          frames.push_back(Frame{true, true});
+          break;
+        case Scanner::TokenType::ListEnd:
+          if (!inValue || !frames.back().isList)
+            break;
+          flushPending();
+          writer.write("]");
+          frames.pop_back();
+          filled = true;
+          break;
+        case Scanner::TokenType::GroupBegin:
+          if (filled || frames.back().isList)
+            return fail();
+          writer.capture(false);
+          writer.write("{");
+          frames.push_back(Frame());
+          keys.push_back(key);
+          paths.push_back(path);
+          inValue = false;
+          break;
+        case Scanner::TokenType::GroupEnd:
+          writer.write("}");
+          frames.pop_back();
+          closing = keys.back();
+          keys.pop_back();
+          paths.pop_back();
+          desc.clear();
+          afterGroup = true;
+          break;
+        case Scanner::TokenType::Comment:
+          if (inValue || afterGroup)
+            desc = token.text;
+          break;
+        case Scanner::TokenType::End:
+          flushPending();
+          if (inValue && !filled)
+            return fail();
+          while (frames.size() > keys.size() + 1)
+          {
+            writer.write(frames.back().isList ? "]" : "}");
+            frames.pop_back();
+          }
+          if (inValue && writer.capturing())
+          {
+            auto it = seen.find(path);
+            if (it != seen.end())
+              seenBytes -= it->first.size() + it->second.size();
+            seenBytes += path.size() + writer.captured().size();
+            seen[path] = writer.captured();
+          }
+          writer.capture(false);
+          if (!desc.empty() && !options.descSuffix.empty() &&
+              (inValue || afterGroup))
+          {
+            separate();
+            _jsonString(writer, (afterGroup ? closing : key) +
+                                    options.descSuffix);
+            writer.write(":");
+            _jsonString(writer, desc);
+          }
+          desc.clear();
+          inValue = afterGroup = filled = false;
+          break;
+        default:
+          break;
+        }
+        return false;
+      };
+      vec<char> chunk(std::max<size_t>(options.bufferSize, 1));
+      while (!scanner.done() && in)
+      {
+        in.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        scanner.feed(strv(chunk.data(), static_cast<size_t>(in.gcount())),
+                     handler);
+      }
+      flushPending();
+      while (frames.size() > 1)
+      {
+        writer.write(frames.back().isList ? "]" : "}");
+        frames.pop_back();
+      }
+      writer.write("}");
+      writer.flush();
+      return ok && scanner.done() && static_cast<bool>(out);
+    }
+    static FVV_INLINE str FromFVV(const strv &txt)
+    {
+      return FromFVV(txt, Options());
+    }
+    static FVV_INLINE str FromFVV(const strv &txt, const Options &options)
+    {
+      std::istringstream in{str(txt)};
+      std::ostringstream out;
+      FromFVV(in, out, options);
+      return out.str();
+    }
+    static FVV_INLINE bool ToFVV(std::istream &in, std::ostream &out)
+    {
+      return ToFVV(in, out, Options());
+    }
+    static FVV_INLINE bool ToFVV(std::istream &in, std::ostream &out,
+                                 const Options &options)
+    {
+      struct Frame
+      {
+        bool isList = false;
+        bool expectKey = true;
+        bool pending = false;
+        bool inDesc = false;
+        str name = "";
+        str key = "";
+        str lastKey = "";
+        char kind = 0;
+      };
+      _Writer writer(out, options.bufferSize);
+      vec<Frame> frames;
+      uint8_t refState = 0;
+      str refName;
+      bool ok = true, finished = false;
+      auto fail = [&ok](void)
+      {
+        ok = false;
+        return true;
+      };
+      auto fvvString = [&writer](const str &text, char quote) -> bool
+      {
+        if (!text.empty() && text.back() == '\\')
+          return false;
+        str escaped;
+        _escape(escaped, text, quote);
+        writer.write(escaped);
+        return true;
+      };
+      auto assign = [&writer](const str &key)
+      {
+        writer.write(key);
+        writer.write("=");
+      };
+      auto scalar = [&](const _JsonLexer::Token &token) -> bool
+      {
+        const char *begin = token.text.data();
+        const char *end = begin + token.text.size();
+        if (token.type == _JsonLexer::TokenType::String)
+        {
+          writer.write("\"");
+          if (!fvvString(token.text, '"'))
+            return false;
+          writer.write("\"");
+        }
+        else if (token.type != _JsonLexer::TokenType::Number ||
+                 token.text.find_first_of("eE") == str::npos)
+        {
+          int number = 0;
+          if (token.type == _JsonLexer::TokenType::Number &&
+              token.text.find('.') == str::npos &&
+              std::from_chars(begin, end, number).ec != std::errc())
+            return false;
+          writer.write(token.text);
+        }
+        else
+        {
+          double number = 0;
+          if (std::from_chars(begin, end, number).ec != std::errc() ||
+              !_isExactDouble(number))
+            return false;
+          str text;
+          _printDouble(text, number, true);
+          writer.write(text);
+        }
+        return true;
+      };
+      auto kindOf = [](const _JsonLexer::Token &token) -> char
+      {
+        if (token.type == _JsonLexer::TokenType::String)
+          return 's';
+        if (token.type == _JsonLexer::TokenType::Number)
+          return token.text.find_first_of(".eE") == str::npos ? 'i' : 'd';
+        return token.text == strv("null") ? 0 : 'b';
+      };
+      auto closeObject = [&](void)
+      {
+        Frame frame = std::move(frames.back());
+        frames.pop_back();
+        if (frame.pending)
+          writer.write(";");
+        writer.write("}");
+        if (frames.empty())
+          finished = true;
+        else
+        {
+          frames.back().pending = true;
+          frames.back().lastKey = frame.name;
+        }
+      };
+      auto handler = [&](const _JsonLexer::Token &token) -> bool
+      {
+        using TokenType = _JsonLexer::TokenType;
+        if (frames.empty())
+        {
+          if (token.type != TokenType::ObjectBegin)
+            return fail();
+          writer.write("{");
+          frames.push_back(Frame());
+          return false;
+        }
+        if (refState == 1)
+        {
+          if (token.type == TokenType::String && token.text == strv("$ref"))
+          {
+            refState = 2;
+            return false;
+          }
+          refState = 0;
+          assign(frames.back().key);
+          writer.write("{");
+          frames.push_back(Frame{false, true, false, false,
+                                 frames.back().key, "", "", 0});
+          if (token.type == TokenType::ObjectEnd)
+          {
+            closeObject();
+            return false;
+          }
+        }
+        else if (refState == 2)
+        {
+          if (token.type == TokenType::Colon)
+            return false;
+          if (token.type != TokenType::String)
+            return fail();
+          refName = token.text;
+          refState = 3;
+          return false;
+        }
+        else if (refState == 3)
+        {
+          if (token.type != TokenType::ObjectEnd || !_isKey(refName))
+            return fail();
+          refState = 0;
+          assign(frames.back().key);
+          writer.write(refName);
+          frames.back().pending = true;
+          frames.back().lastKey = frames.back().key;
+          return false;
+        }
+        Frame &frame = frames.back();
+        if (frame.isList)
+        {
+          if (token.type == TokenType::ListEnd)
+          {
+            if (frame.kind == 0)
+              return fail();
+            writer.write("]");
+            frames.pop_back();
+            frames.back().pending = true;
+            frames.back().lastKey = frames.back().key;
+          }
+          else if (token.type == TokenType::String ||
+                   token.type == TokenType::Number ||
+                   token.type == TokenType::Literal)
+          {
+            const char kind = kindOf(token);
+            if (kind == 0 || (frame.kind != 0 && frame.kind != kind &&
+                              (frame.kind != 'd' || kind != 'i')))
+              return fail();
+            if (!frame.expectKey)
+              writer.write(",");
+            frame.expectKey = false;
+            frame.kind = frame.kind == 0 ? kind : frame.kind;
+            if (!scalar(token))
+              return fail();
+          }
+          else if (token.type != TokenType::Comma)
+            return fail();
+          return false;
+        }
+        if (token.type == TokenType::ObjectEnd)
+          closeObject();
+        else if (token.type == TokenType::Comma)
+          frame.expectKey = true;
+        else if (token.type == TokenType::Colon)
+          return false;
+        else if (frame.expectKey)
+        {
+          if (token.type != TokenType::String)
+            return fail();
+          frame.expectKey = false;
+          frame.inDesc = frame.pending && !options.descSuffix.empty() &&
+                         token.text == frame.lastKey + options.descSuffix;
+          if (frame.pending && !frame.inDesc)
+          {
+            writer.write(";");
+            frame.pending = false;
+          }
+          frame.key = token.text;
+        }
+        else if (frame.inDesc)
+        {
+          if (token.type != TokenType::String)
+            return fail();
+          writer.write("<");
+          if (!fvvString(token.text, '>'))
+            return fail();
+          writer.write(">;");
+          frame.inDesc = frame.pending = false;
+        }
+        else if (!_isKey(frame.key))
+          return fail();
+        else if (token.type == TokenType::ObjectBegin)
+          refState = 1;
+        else if (token.type == TokenType::ListBegin)
+        {
+          assign(frame.key);
+          writer.write("[");
+          frames.push_back(Frame{true, true, false, false, "", "", "", 0});
+        }
+        else if (token.type == TokenType::Literal && token.text == strv("null"))
+          frame.lastKey.clear();
+        else
+        {
+          assign(frame.key);
+          if (!scalar(token))
+            return fail();
+          frame.pending = true;
+          frame.lastKey = frame.key;
+        }
+        return finished;
+      };
+      _JsonLexer lexer;
+      vec<char> chunk(std::max<size_t>(options.bufferSize, 1));
+      while (ok && !finished && in)
+      {
+        in.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        ok = lexer.feed(strv(chunk.data(), static_cast<size_t>(in.gcount())),
+                        handler) &&
+             ok;
+      }
+      if (ok && !finished)
+        ok = lexer.finish(handler) && ok;
+      writer.flush();
+      return ok && finished && static_cast<bool>(out);
+    }
+    static FVV_INLINE str ToFVV(const strv &txt)
+    {
+      return ToFVV(txt, Options());
+    }
+    static FVV_INLINE str ToFVV(const strv &txt, const Options &options)
+    {
+      std::istringstream in{str(txt)};
+      std::ostringstream out;
+      ToFVV(in, out, options);
+      return out.str();
+    }
+
+  private:
+    class _Writer
+    {
+    public:
+      FVV_INLINE _Writer(std::ostream &out, size_t limit)
+          : _out(out), _limit(limit)
+      {
+        _buffer.reserve(limit);
+      }
+      FVV_INLINE void write(const strv &text)
+      {
+        _buffer += text;
+        if (_capturing && _captured.size() + text.size() > _captureLimit)
+          capture(false);
+        if (_capturing)
+          _captured += text;
+        if (_buffer.size() >= _limit)
+          flush();
+      }
+      FVV_INLINE void capture(bool enable, size_t limit = str::npos)
+      {
+        _capturing = enable;
+        _captureLimit = limit;
+        _captured.clear();
+      }
+      FVV_INLINE bool capturing(void) const { return _capturing; }
+      FVV_INLINE const str &captured(void) const { return _captured; }
+      FVV_INLINE void flush(void)
+      {
+        _out.write(_buffer.data(),
+                   static_cast<std::streamsize>(_buffer.size()));
+        _buffer.clear();
+      }
+
+    private:
+      std::ostream &_out;
+      size_t _limit;
+      str _buffer;
+      str _captured;
+      size_t _captureLimit = str::npos;
+      bool _capturing = false;
+    };
+    class _JsonLexer
+    {
+    public:
+      enum class TokenType : uint8_t
+      {
+        ObjectBegin,
+        ObjectEnd,
+        ListBegin,
+        ListEnd,
+        Colon,
+        Comma,
+        String,
+        Number,
+        Literal,
+      };
+      struct Token
+      {
+        TokenType type = TokenType::Literal;
+        str text = "";
+      };
+      using Handler = std::function<bool(const Token &)>;
+      FVV_INLINE bool feed(const strv &chunk, const Handler &handler)
+      {
+        for (const char c : chunk)
+        {
+          if (_done || _failed)
+            break;
+          if (_inString)
+            _string(c, handler);
+          else
+          {
+            if (!_word.empty() && !_isWordChar(c))
+              _flush(handler);
+            if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+              continue;
+            else if (c == '"')
+            {
+              _inString = true;
+              _token = Token{TokenType::String, str("")};
+            }
+            else if (c == '{')
+              _emit(handler, Token{TokenType::ObjectBegin});
+            else if (c == '}')
+              _emit(handler, Token{TokenType::ObjectEnd});
+            else if (c == '[')
+              _emit(handler, Token{TokenType::ListBegin});
+            else if (c == ']')
+              _emit(handler, Token{TokenType::ListEnd});
+            else if (c == ':')
+              _emit(handler, Token{TokenType::Colon});
+            else if (c == ',')
+              _emit(handler, Token{TokenType::Comma});
+            else if (_isWordChar(c))
+              _word += c;
+            else
+              _failed = true;
+          }
+        }
+        return !_failed;
+      }
+      FVV_INLINE bool finish(const Handler &handler)
+      {
+        if (!_word.empty())
+          _flush(handler);
+        return !_failed && !_inString;
+      }
+
+    private:
+      bool _inString = false, _escaped = false, _done = false,
+           _failed = false;
+      uint8_t _hexLeft = 0;
+      uint32_t _unit = 0, _high = 0;
+      str _word;
+      Token _token;
+      static FVV_INLINE bool _isWordChar(char c)
+      {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '+' ||
+               c == '-' || c == '.';
+      }
+      FVV_INLINE void _emit(const Handler &handler, const Token &token)
+      {
+        if (handler(token))
+          _done = true;
+      }
+      FVV_INLINE void _flush(const Handler &handler)
+      {
+        if (_word == strv("true") || _word == strv("false") ||
+            _word == strv("null"))
+          _emit(handler, Token{TokenType::Literal, _word});
+        else if (_isNumber(_word))
+          _emit(handler, Token{TokenType::Number, _word});
+        else
+          _failed = true;
+        _word.clear();
+      }
+      static FVV_INLINE bool _isNumber(const str &word)
+      {
+        const size_t e = word.find_first_of("eE");
+        if (e == str::npos)
+          return _isInt(word) || _isDouble(word);
+        const strv mantissa = strv(word).substr(0, e);
+        return (_isInt(mantissa) || _isDouble(mantissa)) &&
+               _isInt(strv(word).substr(e + 1));
+      }
+      FVV_INLINE void _append(uint32_t code)
+      {
+        if (code < 0x80)
+          _token.text += static_cast<char>(code);
+        else if (code < 0x800)
+        {
+          _token.text += static_cast<char>(0xC0 | (code >> 6));
+          _token.text += static_cast<char>(0x80 | (code & 0x3F));
+        }
+        else if (code < 0x10000)
+        {
+          _token.text += static_cast<char>(0xE0 | (code >> 12));
+          _token.text += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+          _token.text += static_cast<char>(0x80 | (code & 0x3F));
+        }
+        else
+        {
+          _token.text += static_cast<char>(0xF0 | (code >> 18));
+          _token.text += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+          _token.text += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+          _token.text += static_cast<char>(0x80 | (code & 0x3F));
+        }
+      }
+      FVV_INLINE void _string(char c, const Handler &handler)
+      {
+        if (_hexLeft > 0)
+        {
+          if (!std::isxdigit(static_cast<unsigned char>(c)))
+          {
+            _failed = true;
+            return;
+          }
+          _unit = _unit * 16 + static_cast<uint32_t>(
+                                   std::isdigit(static_cast<unsigned char>(c))
+                                       ? c - '0'
+                                       : std::tolower(c) - 'a' + 10);
+          if (--_hexLeft > 0)
+            return;
+          if (_unit >= 0xD800 && _unit < 0xDC00)
+            _high = _unit;
+          else if (_unit >= 0xDC00 && _unit < 0xE000 && _high != 0)
+          {
+            _append(0x10000 + ((_high - 0xD800) << 10) + (_unit - 0xDC00));
+            _high = 0;
+          }
+          else
+            _append(_unit);
+        }
+        else if (_escaped)
+        {
+          _escaped = false;
+          switch (c)
+          {
+          case 'b':
+            _token.text += '\b';
+            break;
+          case 'f':
+            _token.text += '\f';
+            break;
+          case 'n':
+            _token.text += '\n';
+            break;
+          case 'r':
+            _token.text += '\r';
+            break;
+          case 't':
+            _token.text += '\t';
+            break;
+          case 'u':
+            _hexLeft = 4;
+            _unit = 0;
+            break;
+          default:
+            _token.text += c;
+            break;
+          }
+        }
+        else if (c == '\\')
+          _escaped = true;
+        else if (c == '"')
+        {
+          _inString = false;
+          _emit(handler, _token);
+        }
+        else
+          _token.text += c;
+      }
+    };
+    static FVV_INLINE bool _isKey(const str &key)
+    {
+      return !key.empty() &&
+             key.find_first_of(" \t\r\n=;,{}[]<>\"") == str::npos;
+    }
+    static FVV_INLINE str _jsonNumber(const str &text)
+    {
+      str result;
+      strv body = text;
+      if (body.front() == '-')
+        result += '-';
+      if (body.front() == '-' || body.front() == '+')
+        body.remove_prefix(1);
+      const size_t dot = body.find('.');
+      strv integer = body.substr(0, dot);
+      const strv fraction = dot == strv::npos ? strv() : body.substr(dot + 1);
+      while (integer.size() > 1 && integer.front() == '0')
+        integer.remove_prefix(1);
+      result += integer.empty() ? strv("0") : integer;
+      if (!fraction.empty())
+      {
+        result += '.';
+        result += fraction;
+      }
+      return result;
+    }
+    static FVV_INLINE void _jsonString(_Writer &writer, const str &text)
+    {
+      static constexpr const char hex[] = "0123456789abcdef";
+      writer.write("\"");
+      size_t clean = 0;
+      for (size_t i = 0; i < text.size(); ++i)
+      {
+        const unsigned char u = static_cast<unsigned char>(text[i]);
+        if (u >= 0x20 && u != '"' && u != '\\')
+          continue;
+        writer.write(strv(text).substr(clean, i - clean));
+        clean = i + 1;
+        if (u == '"' || u == '\\')
+          writer.write(u == '"' ? "\\\"" : "\\\\");
+        else if (u == '\n')
+          writer.write("\\n");
+        else if (u == '\r')
+          writer.write("\\r");
+        else if (u == '\t')
+          writer.write("\\t");
+        else
+        {
+          const char escaped[] = {'\\', 'u', '0', '0', hex[u >> 4],
+                                  hex[u & 0xF]};
+          writer.write(strv(escaped, sizeof(escaped)));
+        }
+      }
+      writer.write(strv(text).substr(clean));
+      writer.write("\"");
+    }
+  };
+  class Overlay
+  {
+  public:
+    struct Node
+    {
+      std::shared_ptr<const FVVV> self;
+      std::map<str, std::shared_ptr<const Node>> children = {};
+      bool merged = false;
+      std::shared_ptr<const FVVV> linked = nullptr;
+      FVV_INLINE const FVVV &get(void) const { return *self; }
+      FVV_INLINE std::shared_ptr<const Node> at(const strv &key) const
+      {
+        if (merged)
+        {
+          auto it = children.find(str(key));
+          return it == children.end() ? nullptr : it->second;
+        }
+        auto it = self->children.find(str(key));
+        if (it == self->children.end() || _isBlank(it->second))
+          return nullptr;
+        return std::make_shared<const Node>(
+            Node{std::shared_ptr<const FVVV>(self, &it->second)});
+      }
+      FVV_INLINE std::shared_ptr<const Node> find(const strv &path) const
+      {
+        std::shared_ptr<const Node> result;
+        const Node *node = this;
+        for (const str &name : _split(str(path), '.'))
+        {
+          result = node->at(name);
+          if (!result)
+            return nullptr;
+          node = result.get();
+        }
+        return result;
+      }
+      FVV_INLINE std::shared_ptr<const Node> set(const strv &path,
+                                                 const FVVV &newValue) const
+      {
+        const vec<str> names = _split(str(path), '.');
+        std::function<std::shared_ptr<const Node>(const Node *, size_t)>
+            setFunc;
+        setFunc = [&](const Node *node,
+                      size_t index) -> std::shared_ptr<const Node>
+        {
+          if (index == names.size())
+            return std::make_shared<const Node>(
+                Node{std::make_shared<const FVVV>(newValue)});
+          Node result = node != nullptr
+                            ? node->_unshare()
+                            : Node{std::make_shared<const FVVV>(), {}, true};
+          auto it = result.children.find(names[index]);
+          result.children[names[index]] = setFunc(
+              it == result.children.end() ? nullptr : it->second.get(),
+              index + 1);
+          return std::make_shared<const Node>(std::move(result));
+        };
+        return _relink(setFunc(this, 0));
+      }
+      FVV_INLINE FVVV materialize(void) const
+      {
+        FVVV result;
+        std::function<void(const Node *, FVVV &)> copyFunc;
+        copyFunc = [&copyFunc](const Node *node, FVVV &target)
+        {
+          target = *node->self;
+          for (const auto &[key, child] : node->children)
+            copyFunc(child.get(), target[key]);
+        };
+        copyFunc(this, result);
+        std::function<void(FVVV *)> linkFunc;
+        linkFunc = [&](FVVV *node)
+        {
+          for (auto &[key, child] : node->children)
+          {
+            if (!child.linkName.empty())
+              child.setLink(_resolveLink(node, &result, child.linkName));
+            linkFunc(&child);
+          }
+        };
+        linkFunc(&result);
+        return result;
+      }
+
+    private:
+      friend class Overlay;
+      static FVV_INLINE std::shared_ptr<const Node>
+      _resolve(const std::shared_ptr<const Node> &root, const vec<str> &scope,
+               const str &linkName)
+      {
+        std::shared_ptr<const Node> scopeNode = root;
+        for (const str &name : scope)
+          if (scopeNode)
+            scopeNode = scopeNode->at(name);
+        for (std::shared_ptr<const Node> target : {scopeNode, root})
+        {
+          if (!target)
+            continue;
+          for (const str &name : _split(linkName, '.'))
+            if (std::shared_ptr<const Node> child = target->at(name))
+              target = std::move(child);
+          if (target->get().isNotEmpty() || !target->children.empty())
+            return target;
+        }
+        return nullptr;
+      }
+      static FVV_INLINE std::shared_ptr<const Node>
+      _relink(const std::shared_ptr<const Node> &root)
+      {
+        struct Pending
+        {
+          std::shared_ptr<Node> node;
+          FVVV *own;
+          vec<str> scope;
+        };
+        vec<Pending> pending;
+        std::function<bool(const FVVV &)> hasLinkFunc;
+        hasLinkFunc = [&hasLinkFunc](const FVVV &node)
+        {
+          if (!node.linkName.empty())
+            return true;
+          for (const auto &[key, child] : node.children)
+            if (hasLinkFunc(child))
+              return true;
+          return false;
+        };
+        std::function<std::shared_ptr<const Node>(
+            const std::shared_ptr<const Node> &, vec<str> &)>
+            relinkFunc;
+        relinkFunc = [&](const std::shared_ptr<const Node> &node,
+                         vec<str> &path) -> std::shared_ptr<const Node>
+        {
+          if (!node->merged && !hasLinkFunc(*node->self))
+            return node;
+          auto result = std::make_shared<Node>(node->_unshare());
+          bool changed = !node->merged;
+          if (!result->self->linkName.empty() && !path.empty())
+          {
+            changed = true;
+            auto own = std::make_shared<FVVV>();
+            own->value = result->self->value;
+            own->desc = result->self->desc;
+            own->linkName = result->self->linkName;
+            pending.push_back(Pending{
+                result, own.get(), vec<str>(path.begin(), path.end() - 1)});
+            result->self = std::move(own);
+          }
+          for (auto &[key, child] : result->children)
+          {
+            path.push_back(key);
+            std::shared_ptr<const Node> relinked = relinkFunc(child, path);
+            path.pop_back();
+            changed = changed || relinked != child;
+            child = std::move(relinked);
+          }
+          if (!changed)
+            return node;
+          return result;
+        };
+        vec<str> path;
+        const std::shared_ptr<const Node> result = relinkFunc(root, path);
+        for (const Pending &item : pending)
+        {
+          const std::shared_ptr<const Node> target =
+              _resolve(result, item.scope, item.own->linkName);
+          item.node->linked = target ? target->self : nullptr;
+          item.own->link =
+              target ? const_cast<FVVV *>(target->self.get()) : nullptr;
+        }
+        return result;
+      }
+      FVV_INLINE Node _unshare(void) const
+      {
+        if (merged)
+          return *this;
+        FVVV own;
+        own.value = self->value;
+        own.desc = self->desc;
+        own.link = self->link;
+        own.linkName = self->linkName;
+        Node result{std::make_shared<const FVVV>(std::move(own)), {}, true};
+        for (const auto &[key, child] : self->children)
+          if (!_isBlank(child))
+            result.children.emplace(
+                key, std::make_shared<const Node>(
+                         Node{std::shared_ptr<const FVVV>(self, &child)}));
+        return result;
+      }
+    };
+    FVV_INLINE void push(std::shared_ptr<const FVVV> layer)
+    {
+      _layers.push_back(std::move(layer));
+    }
+    FVV_INLINE void push(const FVVV &layer)
+    {
+      _layers.push_back(
+          std::shared_ptr<const FVVV>(std::shared_ptr<const FVVV>(), &layer));
+    }
+    FVV_INLINE void pop(void)
+    {
+      if (!_layers.empty())
+        _layers.pop_back();
+    }
+    FVV_INLINE size_t size(void) const { return _layers.size(); }
+    FVV_INLINE const FVVV *find(const strv &path) const
+    {
+      vec<str> names = _split(str(path), '.');
+      const FVVV *node = _lookup(names);
+      for (size_t depth = 0; node != nullptr && !node->linkName.empty() &&
+                             !names.empty() && depth < _linkDepth;
+           ++depth)
+      {
+        names.pop_back();
+        const FVVV *target = nullptr;
+        for (vec<str> candidate : {names, vec<str>()})
+        {
+          for (const str &name : _split(node->linkName, '.'))
+          {
+            candidate.push_back(name);
+            if (_lookup(candidate) == nullptr)
+              candidate.pop_back();
+          }
+          target = _lookup(candidate);
+          if (target != nullptr && target->isNotEmpty())
+          {
+            names = std::move(candidate);
+            break;
+          }
+          target = nullptr;
+        }
+        if (target == nullptr)
+          break;
+        node = target;
+      }
+      return node;
+    }
+    FVV_INLINE std::shared_ptr<const Node> flatten(void) const
+    {
+      using layerNodes = vec<std::shared_ptr<const FVVV>>;
+      std::function<std::shared_ptr<const Node>(const layerNodes &)> mergeFunc;
+      mergeFunc = [&mergeFunc](const layerNodes &nodes)
+      {
+        if (nodes.empty())
+          return std::make_shared<const Node>(
+              Node{std::make_shared<const FVVV>()});
+        if (nodes.size() == 1)
+          return std::make_shared<const Node>(Node{nodes.front()});
+        FVVV own;
+        own.value = nodes.front()->value;
+        own.link = nodes.front()->link;
+        own.linkName = nodes.front()->linkName;
+        for (const auto &node : nodes)
+          if (own.desc.empty())
+            own.desc = node->desc;
+        std::map<str, layerNodes> grouped;
+        for (const auto &node : nodes)
+          for (const auto &[key, child] : node->children)
+          {
+            if (_isBlank(child))
+              continue;
+            layerNodes &candidates = grouped[key];
+            if (!candidates.empty() && candidates.back()->children.empty())
+              continue;
+            candidates.push_back(std::shared_ptr<const FVVV>(node, &child));
+          }
+        Node result{std::make_shared<const FVVV>(std::move(own)), {}, true};
+        for (const auto &[key, candidates] : grouped)
+          result.children.emplace(key, mergeFunc(candidates));
+        return std::make_shared<const Node>(std::move(result));
+      };
+      return Node::_relink(
+          mergeFunc(layerNodes(_layers.rbegin(), _layers.rend())));
+    }
+
+  private:
+    static constexpr const size_t _linkDepth = 16;
+    vec<std::shared_ptr<const FVVV>> _layers;
+    FVV_INLINE const FVVV *_lookup(const vec<str> &names) const
+    {
+      vec<const FVVV *> nodes;
+      for (size_t i = _layers.size(); i-- > 0;)
+        nodes.push_back(_layers[i].get());
+      for (const str &name : names)
+      {
+        vec<const FVVV *> next;
+        for (const FVVV *node : nodes)
+        {
+          auto it = node->children.find(name);
+          if (it == node->children.end() || _isBlank(it->second))
+            continue;
+          next.push_back(&it->second);
+          if (it->second.children.empty())
+            break;
+        }
+        nodes.swap(next);
+      }
+      return nodes.empty() ? nullptr : nodes.front();
+    }
+  };
+  static Task<std::optional<FVVV>> loadAsync(str path)
+  {
+    return loadAsync(std::move(path), Options());
+  }
+  static Task<std::optional<FVVV>> loadAsync(str path, Options options)
+  {
+    str txt;
+    const bool ok = co_await _readFile(path, txt, options.stop);
+    std::optional<FVVV> result;
+    if (ok && !options.stop.stop_requested())
+    {
+      co_await _Offload();
+      result.emplace();
+      Parser::ReadString(std::move(txt), *result, options);
+      if (options.stop.stop_requested())
+        result.reset();
+    }
+    co_await _ResumeOn{options.executor};
+    co_return result;
+  }
+  static Task<bool> saveAsync(str path, FVVV doc)
+  {
+    return saveAsync(std::move(path), std::move(doc), Options());
+  }
+  static Task<bool> saveAsync(str path, FVVV doc, Options options)
+  {
+    co_await _Offload();
+    const str txt = doc.print("common", options);
+    bool ok = !options.stop.stop_requested();
+    if (ok)
+    {
+      static std::atomic<uint64_t> serial = 0;
+      const str tmpPath =
+          path + str(".") +
+          std::to_string(std::hash<std::thread::id>()(
+              std::this_thread::get_id())) +
+          str("-") + std::to_string(serial++) + str(".tmp");
+      std::error_code ec;
+      std::optional<std::filesystem::perms> mode;
+      const std::filesystem::file_status status =
+          std::filesystem::status(path, ec);
+      if (!ec && std::filesystem::exists(status))
+        mode = status.permissions() & std::filesystem::perms::mask;
+      ok = co_await _writeFile(tmpPath, txt, mode, options.stop);
+      if (ok)
+        std::filesystem::rename(tmpPath, path, ec);
+      if (!ok || ec)
+      {
+        std::filesystem::remove(tmpPath, ec);
+        ok = false;
+      }
+#if FVV_POSIX_IO
+      else
+        ok = _syncDir(path);
+#endif
+    }
+    co_await _ResumeOn{options.executor};
+    co_return ok;
+  }
+  static FVV_INLINE bool _isInt(const strv &s)
+  {
+    if (s.empty())
+      return false;
+    size_t start = 0;
+    if (s[0] == '-' || s[0] == '+')
+    {
+      if (s.size() == 1)
+        return false;
+      start = 1;
+    }
+    return std::all_of(s.begin() + start, s.end(), ::isdigit);
+  }
+  static FVV_INLINE bool _isDouble(const strv &s)
+  {
+    if (s.empty())
+      return false;
+    size_t start = 0;
+    bool hasDigit = false, hasDot = false;
+    if (s[0] == '-' || s[0] == '+')
+    {
+      if (s.size() == 1)
+        return false;
+      start = 1;
+    }
+    for (size_t i = start; i < s.size(); ++i)
+    {
+      char c = s[i];
+      if (std::isdigit(c))
+        hasDigit = true;
+      else if (c == '.')
+      {
+        if (hasDot)
+          return false;
+        hasDot = true;
+      }
+      else
+        return false;
+    }
+    return hasDigit;
+  }
+
+private:
+  static constexpr const size_t _ioChunk = 1 << 20;
+  class _ThreadPool
+  {
+  public:
+    FVV_INLINE explicit _ThreadPool(size_t size)
+    {
+      for (size_t i = 0; i < size; ++i)
+        _workers.emplace_back([this](std::stop_token stop) { _run(stop); });
+    }
+    FVV_INLINE void post(std::function<void()> job)
+    {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _jobs.push_back(std::move(job));
+      }
+      _cv.notify_one();
+    }
+
+  private:
+    std::mutex _mutex;
+    std::condition_variable_any _cv;
+    std::deque<std::function<void()>> _jobs;
+    vec<std::jthread> _workers;
+    FVV_INLINE void _run(std::stop_token stop)
+    {
+      while (true)
+      {
+        std::function<void()> job;
+        {
+          std::unique_lock<std::mutex> lock(_mutex);
+          if (!_cv.wait(lock, stop, [this] { return !_jobs.empty(); }))
+            return;
+          job = std::move(_jobs.front());
+          _jobs.pop_front();
+        }
+        job();
+      }
+    }
+  };
+  static FVV_INLINE _ThreadPool &_pool(void)
+  {
+    static _ThreadPool pool(
+        std::max<size_t>(2, std::thread::hardware_concurrency()));
+    return pool;
+  }
+  struct _Offload
+  {
+    FVV_INLINE bool await_ready(void) const noexcept { return false; }
+    FVV_INLINE void await_suspend(std::coroutine_handle<> handle) const
+    {
+      _pool().post([handle] { handle.resume(); });
+    }
+    FVV_INLINE void await_resume(void) const noexcept {}
+  };
+  struct _ResumeOn
+  {
+    const std::function<void(std::coroutine_handle<>)> &executor;
+    FVV_INLINE bool await_ready(void) const noexcept { return !executor; }
+    FVV_INLINE void await_suspend(std::coroutine_handle<> handle) const
+    {
+      executor(handle);
+    }
+    FVV_INLINE void await_resume(void) const noexcept {}
+  };
+#if FVV_IO_URING
+  class _Ring
+  {
+  public:
+    struct Op
+    {
+      _Ring &ring;
+      std::function<void(io_uring_sqe *)> prepare;
+      std::coroutine_handle<> handle = nullptr;
+      int result = -EAGAIN;
+      FVV_INLINE bool await_ready(void) const noexcept { return false; }
+      FVV_INLINE bool await_suspend(std::coroutine_handle<> awaiting)
+      {
+        handle = awaiting;
+        return ring._submit(this);
+      }
+      FVV_INLINE int await_resume(void) const noexcept { return result; }
+    };
+    FVV_INLINE _Ring(void)
+    {
+      _ok = io_uring_queue_init(_depth, &_ring, 0) == 0;
+      if (_ok)
+        _reaper = std::jthread([this] { _reap(); });
+    }
+    FVV_INLINE ~_Ring(void)
+    {
+      if (!_ok)
+        return;
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        io_uring_sqe *sqe = _sqe();
+        if (sqe != nullptr)
+        {
+          io_uring_prep_nop(sqe);
+          io_uring_sqe_set_data(sqe, this);
+          io_uring_submit(&_ring);
+        }
+      }
+      if (_reaper.joinable())
+        _reaper.join();
+      io_uring_queue_exit(&_ring);
+    }
+    FVV_INLINE bool ok(void) const { return _ok; }
+    FVV_INLINE Op op(std::function<void(io_uring_sqe *)> prepare)
+    {
+      return Op{*this, std::move(prepare)};
+    }
+
+  private:
+    static constexpr const unsigned _depth = 64;
+    io_uring _ring;
+    bool _ok = false;
+    unsigned _inFlight = 0;
+    std::mutex _mutex;
+    std::condition_variable _space;
+    std::jthread _reaper;
+    FVV_INLINE io_uring_sqe *_sqe(void)
+    {
+      io_uring_sqe *sqe = io_uring_get_sqe(&_ring);
+      if (sqe == nullptr && io_uring_submit(&_ring) >= 0)
+        sqe = io_uring_get_sqe(&_ring);
+      return sqe;
+    }
+    FVV_INLINE bool _submit(Op *op)
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _space.wait(lock, [this](void) { return _inFlight < _depth; });
+      io_uring_sqe *sqe = _sqe();
+      if (sqe == nullptr)
+        return false;
+      op->prepare(sqe);
+      io_uring_sqe_set_data(sqe, op);
+      if (io_uring_submit(&_ring) < 0)
+      {
+        io_uring_prep_nop(sqe);
+        io_uring_sqe_set_data(sqe, nullptr);
+        return false;
+      }
+      ++_inFlight;
+      return true;
+    }
+    FVV_INLINE void _reap(void)
+    {
+      while (true)
+      {
+        io_uring_cqe *cqe = nullptr;
+        const int rc = io_uring_wait_cqe(&_ring, &cqe);
+        if (rc == -EINTR)
+          continue;
+        if (rc < 0)
+          return;
+        void *data = io_uring_cqe_get_data(cqe);
+        const int result = cqe->res;
+        io_uring_cqe_seen(&_ring, cqe);
+        if (data == this)
+          return;
+        if (data == nullptr)
+          continue;
+        {
+          std::lock_guard<std::mutex> lock(_mutex);
+          --_inFlight;
+        }
+        _space.notify_one();
+        Op *op = static_cast<Op *>(data);
+        op->result = result;
+        const std::coroutine_handle<> handle = op->handle;
+        _pool().post([handle](void) { handle.resume(); });
+      }
+    }
+  };
+  static FVV_INLINE _Ring &_ring(void)
+  {
+    _pool();
+    static _Ring ring;
+    return ring;
+  }
+#endif
+#if FVV_POSIX_IO
+  static FVV_INLINE int
+  _openTemp(const str &path, const std::optional<std::filesystem::perms> &mode)
+  {
+    const int fd =
+        ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+               mode ? 0600 : 0666);
+    if (fd >= 0 && mode && ::fchmod(fd, static_cast<mode_t>(*mode)) != 0)
+    {
+      ::close(fd);
+      return -1;
+    }
+    return fd;
+  }
+  static FVV_INLINE bool _syncDir(const str &path)
+  {
+    const str dir = std::filesystem::path(path).parent_path().string();
+    const int fd = ::open(dir.empty() ? "." : dir.c_str(),
+                          O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0)
+      return false;
+    const bool ok = ::fsync(fd) == 0;
+    return ::close(fd) == 0 && ok;
+  }
+#endif
+  static Task<bool> _readFile(const str &path, str &txt, std::stop_token stop)
+  {
+    co_await _Offload();
+    std::error_code ec;
+    const size_t size = std::filesystem::file_size(path, ec);
+    if (ec)
+      co_return false;
+    txt.resize(size);
+#if FVV_IO_URING
+    if (_ring().ok())
+    {
+      const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+      if (fd < 0)
+        co_return false;
+      size_t done = 0;
+      while (done < size && !stop.stop_requested())
+      {
+        const int n = co_await _ring().op(
+            [&](io_uring_sqe *sqe)
+            {
+              io_uring_prep_read(sqe, fd, txt.data() + done,
+                                 std::min(size - done, _ioChunk), done);
+            });
+        if (n <= 0)
+          break;
+        done += static_cast<size_t>(n);
+      }
+      ::close(fd);
+      txt.resize(done);
+      co_return done == size;
+    }
+#endif
+    std::ifstream file(path, std::ios::binary);
+    size_t done = 0;
+    while (file && done < size && !stop.stop_requested())
+    {
+      file.read(txt.data() + done, static_cast<std::streamsize>(
+                                       std::min(size - done, _ioChunk)));
+      done += static_cast<size_t>(file.gcount());
+    }
+    txt.resize(done);
+    co_return done == size;
+  }
+  static Task<bool> _writeFile(const str &path, const str &txt,
+                               std::optional<std::filesystem::perms> mode,
+                               std::stop_token stop)
+  {
+#if FVV_IO_URING
+    if (_ring().ok())
+    {
+      const int fd = _openTemp(path, mode);
+      if (fd < 0)
+        co_return false;
+      size_t done = 0;
+      while (done < txt.size() && !stop.stop_requested())
+      {
+        const int n = co_await _ring().op(
+            [&](io_uring_sqe *sqe)
+            {
+              io_uring_prep_write(sqe, fd, txt.data() + done,
+                                  std::min(txt.size() - done, _ioChunk),
+                                  done);
+            });
+        if (n <= 0)
+          break;
+        done += static_cast<size_t>(n);
+      }
+      const bool ok =
+          done == txt.size() &&
+          co_await _ring().op([fd](io_uring_sqe *sqe)
+                              { io_uring_prep_fsync(sqe, fd, 0); }) == 0;
+      co_return ::close(fd) == 0 && ok;
+    }
+#endif
+#if FVV_POSIX_IO
+    const int fd = _openTemp(path, mode);
+    if (fd < 0)
+      co_return false;
+    size_t done = 0;
+    while (done < txt.size() && !stop.stop_requested())
+    {
+      const ssize_t n =
+          ::write(fd, txt.data() + done, std::min(txt.size() - done, _ioChunk));
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n <= 0)
+        break;
+      done += static_cast<size_t>(n);
+    }
+    const bool ok = done == txt.size() && ::fsync(fd) == 0;
+    co_return ::close(fd) == 0 && ok;
+#else
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    size_t done = 0;
+    while (file && done < txt.size() && !stop.stop_requested())
+    {
+      const size_t n = std::min(txt.size() - done, _ioChunk);
+      file.write(txt.data() + done, static_cast<std::streamsize>(n));
+      done += n;
+    }
+    file.close();
+    std::error_code ec;
+    if (mode)
+      std::filesystem::permissions(path, *mode, ec);
+    co_return static_cast<bool>(file) && !ec && done == txt.size();
+#endif
+  }
+  static FVV_INLINE vec<str> _split(const str &path, char delimiter)
+  {
+    vec<str> result;
+    std::stringstream ss(path);
+    str item;
+    while (std::getline(ss, item, delimiter))
+      result.push_back(item);
+    return result;
+  }
+  static FVV_INLINE size_t _rootEnd(const strv &txt)
+  {
+    for (size_t i = txt.size(); i-- > 0;)
+      if (txt[i] == '}' && (i == 0 || txt[i - 1] != '\\'))
+        return i;
+    return str::npos;
+  }
+  static FVV_INLINE bool _isBlank(const FVVV &node)
+  {
+    return node.isEmpty() && node.desc.empty() && node.linkName.empty();
+  }
+  static FVV_INLINE FVVV *_resolveLink(FVVV *scope, FVVV *root,
+                                       const str &linkName)
+  {
+    const vec<str> names = _split(linkName, '.');
+    for (FVVV *target : {scope, root})
+    {
+      for (const str &name : names)
+      {
+        auto it = target->children.find(name);
+        if (it != target->children.end())
+          target = &it->second;
+      }
+      if (target->isNotEmpty())
+        return target;
+    }
+    return nullptr;
+  }
+  template <typename T>
+  static FVV_INLINE void _shrink(T *container)
+  {
+    if (container)
+      container->shrink_to_fit();
+  }
+  template <typename T, typename... Args>
   static FVV_INLINE void _shrink(T *container, Args... args)
   {
     _shrink(container);
@@ -771,6 +3109,171 @@ private:
     _clearAndShrink(container);
     _clearAndShrink(args...);
   }
+  template <typename... Args>
+  static FVV_INLINE void _shrinkBy(const MemoryPolicy &memory, Args... args)
+  {
+    if (memory == MemoryPolicy::Shrink)
+      _shrink(args...);
+  }
+  template <typename... Args>
+  static FVV_INLINE void _clearBy(const MemoryPolicy &memory, Args... args)
+  {
+    if (memory == MemoryPolicy::Shrink)
+      _clearAndShrink(args...);
+    else
+      (args->clear(), ...);
+  }
+  static constexpr const uint64_t _fnvBasis = 0xcbf29ce484222325ULL;
+  static FVV_INLINE uint64_t _hashBytes(uint64_t h, const void *data,
+                                        size_t size)
+  {
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+      h ^= bytes[i];
+      h *= 0x100000001b3ULL;
+    }
+    return h;
+  }
+  static FVV_INLINE uint64_t _hashMix(uint64_t h, uint64_t v)
+  {
+    return h ^ (v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2));
+  }
+  static FVV_INLINE uint64_t _hashString(uint64_t h, const strv &s)
+  {
+    return _hashBytes(_hashMix(h, s.size()), s.data(), s.size());
+  }
+  template <typename T>
+  static FVV_INLINE uint64_t _hashValue(uint64_t h, T v)
+  {
+    if constexpr (std::is_floating_point_v<T>)
+      if (v == 0)
+        v = 0;
+    return _hashBytes(h, &v, sizeof(v));
+  }
+  static FVV_INLINE size_t _heapBytes(const str &s)
+  {
+    const char *self = reinterpret_cast<const char *>(&s);
+    if (!std::less<const char *>()(s.data(), self) &&
+        std::less<const char *>()(s.data(), self + sizeof(str)))
+      return 0;
+    return s.capacity() + 1;
+  }
+  static FVV_INLINE void _escape(str &result, const str &text, char quote)
+  {
+    _utf8ForEach(text, text.size(),
+                 [&result, quote]([[maybe_unused]] const size_t &index,
+                                  const strv &index_char,
+                                  [[maybe_unused]] const uint8_t &char_size)
+                     -> bool
+                 {
+                   if (index_char.size() == 1 && index_char[0] == quote)
+                     result += str("\\");
+                   result += index_char;
+                   return false;
+                 });
+  }
+  static FVV_INLINE void _printDesc(str &result, const str &desc)
+  {
+    result += str(" <");
+    _escape(result, desc, '>');
+    result += str(">");
+  }
+  template <typename T, typename F>
+  static FVV_INLINE void _printVec(str &result, const vec<T> &values,
+                                   int indentLevel, const strv &type,
+                                   F printItem)
+  {
+    result += str("[");
+    if (values.empty())
+    {
+      result += str("]");
+      return;
+    }
+    str vecIndent((indentLevel + 1) * 2, ' ');
+    if (type == strv("bigvec"))
+      result += str("\n");
+    for (const auto &value : values)
+    {
+      if (type == strv("bigvec"))
+        result += vecIndent;
+      printItem(static_cast<T>(value));
+      result += str(",");
+      if (type == strv("bigvec"))
+        result += str("\n");
+      else if (type != strv("min"))
+        result += str(" ");
+    }
+    if (type != strv("bigvec"))
+    {
+      result.pop_back();
+      if (type != strv("min"))
+        result.pop_back();
+    }
+    else
+      result += str(indentLevel * 2, ' ');
+    result += str("]");
+  }
+  static FVV_INLINE bool _isExactDouble(double value)
+  {
+    return std::isfinite(value) &&
+           (value == 0 ||
+            std::abs(value) >= std::numeric_limits<double>::min());
+  }
+  static FVV_INLINE void _printDouble(str &result, double value, bool exact)
+  {
+    if (!exact)
+    {
+      result += std::to_string(value);
+      return;
+    }
+    char buffer[512];
+    const strv text(buffer, std::to_chars(buffer, buffer + sizeof(buffer),
+                                          value, std::chars_format::fixed)
+                                    .ptr -
+                                buffer);
+    result += text;
+    if (text.find('.') == strv::npos)
+      result += str(".0");
+  }
+  static FVV_INLINE void _printValue(str &result, const FVVV &node,
+                                     int indentLevel, const strv &type,
+                                     bool exact = false)
+  {
+    if (node.isLink() || !node.getLinkName().empty())
+      result += node.getLinkName();
+    else if (node.isType<str>())
+    {
+      result += str("\"");
+      _escape(result, std::get<str>(node.value), '"');
+      result += str("\"");
+    }
+    else if (node.isType<bool>())
+      result += std::get<bool>(node.value) ? str("true") : str("false");
+    else if (node.isType<int>())
+      result += std::to_string(std::get<int>(node.value));
+    else if (node.isType<double>())
+      _printDouble(result, std::get<double>(node.value), exact);
+    else if (node.isType<vec<str>>())
+      _printVec(result, std::get<vec<str>>(node.value), indentLevel, type,
+                [&result](const str &value)
+                {
+                  result += str("\"");
+                  _escape(result, value, '"');
+                  result += str("\"");
+                });
+    else if (node.isType<vec<bool>>())
+      _printVec(result, std::get<vec<bool>>(node.value), indentLevel, type,
+                [&result](bool value)
+                { result += value ? str("true") : str("false"); });
+    else if (node.isType<vec<int>>())
+      _printVec(result, std::get<vec<int>>(node.value), indentLevel, type,
+                [&result](int value) { result += std::to_string(value); });
+    else if (node.isType<vec<double>>())
+      _printVec(result, std::get<vec<double>>(node.value), indentLevel, type,
+                [&result, exact](double value)
+                { _printDouble(result, value, exact); });
+  }
   static FVV_INLINE void _utf8ForEach(
       const str &target, size_t size,
       std::function<bool(const size_t &, const strv &, const uint8_t &)>
@@ -791,7 +3294,7 @@ private:
         char_size = 4;
       else
         char_size = 1;
-      if (handler(i, target.substr(i, char_size), char_size))
+      if (handler(i, strv(target).substr(i, char_size), char_size))
         break;
       i += char_size;
     }
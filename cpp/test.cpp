@@ -0,0 +1,393 @@
+#include <cassert>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "fvv.hpp"
+
+static FVV::FVVV parse(const std::string &txt)
+{
+  FVV::FVVV fvv;
+  FVV::Parser::ReadString(txt, fvv);
+  return fvv;
+}
+
+static void testMemoryPolicy(void)
+{
+  std::string txt = "{";
+  for (int i = 0; i < 64; ++i)
+    txt += "a_fairly_long_key_" + std::to_string(i) + "=\"" +
+           std::string(40, 'v') + "\" <a description that is long>; list" +
+           std::to_string(i) + "=[1,2,3];";
+  txt += "}";
+  FVV::FVVV reused, compacted;
+  FVV::Options options;
+  options.memory = FVV::MemoryPolicy::Reuse;
+  FVV::Parser::ReadString(txt, reused, options);
+  FVV::Parser::ReadString(txt, compacted);
+  assert(reused.print() == compacted.print());
+  const FVV::MemoryUsage before = reused.memoryUsage();
+  assert(before.keys > 0 && before.values > 0 && before.descs > 0);
+  assert(before.containers > 0 && before.caches == 0);
+  assert(before.total() == before.keys + before.values + before.descs +
+                               before.containers + before.caches);
+  reused.compact();
+  const FVV::MemoryUsage after = reused.memoryUsage();
+  assert(after.total() <= before.total());
+  assert(after.total() == compacted.memoryUsage().total());
+  assert(reused.print() == compacted.print());
+  assert(reused.print("common", options) == reused.print());
+}
+
+static void testMoveInvalidatesHash(void)
+{
+  FVV::FVVV root = parse("{a={x=1;};b=2;}");
+  const FVV::FVVV original = root;
+  const uint64_t before = root.hash();
+  FVV::FVVV taken = std::move(root["a"]);
+  assert(taken["x"].asInt() == 1);
+  assert(root.hash() != before);
+  assert(!FVV::FVVV::diff(original, root).empty());
+
+  FVV::FVVV other = parse("{a={x=1;};b=2;}");
+  const uint64_t otherBefore = other.hash();
+  FVV::FVVV target;
+  target = std::move(other["a"]);
+  assert(other.hash() != otherBefore);
+}
+
+static void testTouchPastBlankNode(void)
+{
+  FVV::FVVV root = parse("{a=1;}");
+  root["x"].asInt();
+  const uint64_t before = root.hash();
+  root["x"] = FVV::FVVV(5);
+  assert(root.hash() != before);
+}
+
+static void testOverlay(void)
+{
+  auto base = std::make_shared<const FVV::FVVV>(
+      parse("{a=1;b=a;g={x=1;y=2;};only={k=3;};}"));
+  auto host = std::make_shared<const FVV::FVVV>(parse("{a=2;g={x=5;};}"));
+  FVV::Overlay overlay;
+  overlay.push(base);
+  overlay.push(host);
+  assert(overlay.size() == 2);
+  assert(overlay.find("a")->asInt() == 2);
+  assert(overlay.find("g.x")->asInt() == 5);
+  assert(overlay.find("g.y")->asInt() == 2);
+  assert(overlay.find("only.k")->asInt() == 3);
+  assert(overlay.find("missing") == nullptr);
+  assert(overlay.find("b")->asInt() == 2);
+
+  const auto flat = overlay.flatten();
+  assert(flat->find("a")->get().asInt() == 2);
+  assert(flat->find("g.x")->get().asInt() == 5);
+  assert(flat->find("g.y")->get().asInt() == 2);
+  assert(flat->find("b")->get().asInt() == 2);
+  assert(&flat->find("only")->get() == &base->children.at("only"));
+
+  const auto edited = flat->set("a", FVV::FVVV(7));
+  assert(flat->find("a")->get().asInt() == 2);
+  assert(edited->find("a")->get().asInt() == 7);
+  assert(edited->find("b")->get().asInt() == 7);
+  assert(flat->find("b")->get().asInt() == 2);
+  assert(&edited->find("only")->get() == &base->children.at("only"));
+  assert(edited->find("g") == flat->find("g"));
+
+  const FVV::FVVV merged = edited->materialize();
+  assert(merged.children.at("b").asInt() == 7);
+  assert(merged.children.at("g").children.at("y").asInt() == 2);
+
+  overlay.pop();
+  assert(overlay.find("a")->asInt() == 1);
+  assert(overlay.find("b")->asInt() == 1);
+}
+
+static std::string readFile(const std::string &path)
+{
+  std::ifstream file(path, std::ios::binary);
+  std::ostringstream ss;
+  ss << file.rdbuf();
+  return ss.str();
+}
+
+static void testDocumentReuse(void)
+{
+  const std::string first = "doc_first.fvv", second = "doc_second.fvv";
+  std::ofstream(first) << "{grp={x=1;};}";
+  std::ofstream(second) << "{q=1;}";
+  FVV::Document doc;
+  assert(doc.open(first));
+  assert(doc.set("grp.x", FVV::FVVV(5)));
+  assert(doc.open(second));
+  assert(doc.set("q", FVV::FVVV(2)));
+  assert(doc.save());
+  assert(readFile(second) == "{q=2;}");
+  std::remove(first.c_str());
+  std::remove(second.c_str());
+}
+
+static void testDocumentEdits(void)
+{
+  FVV::Document doc("{a = 1 <one>; b = 2;}");
+  assert(doc.setDesc("a", ""));
+  assert(doc.text() == "{a = 1; b = 2;}");
+  assert(!doc.set("b", FVV::FVVV()));
+  assert(doc.text() == "{a = 1; b = 2;}");
+  for (double value : {1e-7, 0.000001234, 1e22, -2.5})
+  {
+    assert(doc.set("b", FVV::FVVV(value)));
+    assert(std::get<double>(FVV::FVVV(doc.tree())["b"].value) == value);
+  }
+  FVV::FVVV group;
+  group["x"] = FVV::FVVV(1e-7);
+  group["l"] = FVV::FVVV(std::vector<double>{3e-9, 1});
+  assert(doc.set("b", group));
+  assert(std::get<double>(FVV::FVVV(doc.tree())["b"]["x"].value) == 1e-7);
+  assert(std::get<std::vector<double>>(FVV::FVVV(doc.tree())["b"]["l"].value) ==
+         (std::vector<double>{3e-9, 1}));
+  assert(!doc.set("b", FVV::FVVV(1e-310)));
+  FVV::Document descs("{g={<free> a=1;};}");
+  assert(!descs.find("g.a")->desc.empty());
+  assert(descs.setDesc("g.a", ""));
+  assert(FVV::FVVV(descs.tree())["g"]["a"].desc.empty());
+}
+
+static const FVV::FVVV *findPath(const FVV::FVVV &root, const std::string &path)
+{
+  const FVV::FVVV *node = &root;
+  std::stringstream ss(path);
+  std::string key;
+  while (std::getline(ss, key, '.'))
+  {
+    auto it = node->children.find(key);
+    if (it == node->children.end())
+      return nullptr;
+    node = &it->second;
+  }
+  return node;
+}
+
+static void testScannerMatchesParser(void)
+{
+  const char *cases[] = {
+      "{a=1;b=\"x\";c=[1,2];}",
+      "<top {> {a=1;}",
+      "{a=1;} trailing",
+      "{a=1;} b=2;",
+      "{a=1;} {b=2;}",
+      "{a=1;}}",
+      "{a=1;",
+      "{g={a=1;};",
+      "{g={a=1;}<gd>; h=2 <hd>;}",
+      "{a.b.c=1; a.d=2;}",
+      "{s=\"q\\\"x\"; t=\"a}b\";}",
+      "{l=[\"a\",\"b\",]; m=[1.5, 2];}",
+      "{x=y; y=1; z=g.a; g={a=2;};}",
+      "{a=1;}\n<trailing }>",
+      "{ a = 1 ; b = { c = 2 ; } ; }",
+      "{a=1<d\\>x>;}",
+      "{g={<free> a=1;};}",
+      "{<top> g={a=1;}; <x> h=2;}",
+      "{g={a=1;} <gd>; <hd> h={b=2;};}",
+  };
+  for (const char *txt : cases)
+  {
+    const FVV::Document doc(txt);
+    const FVV::FVVV tree = doc.tree();
+    size_t leaves = 0;
+    for (const auto &[path, entry] : doc.entries())
+    {
+      const std::string value = doc.text().substr(
+          entry.value.begin, entry.value.end - entry.value.begin);
+      const FVV::FVVV *node = findPath(tree, path);
+      assert(node != nullptr);
+      FVV::FVVV single;
+      std::string desc;
+      if (!entry.desc.empty())
+        desc = doc.text().substr(entry.desc.begin,
+                                 entry.desc.end - entry.desc.begin);
+      if (value.front() == '{')
+      {
+        FVV::Parser::ReadString("{x=0" + desc + ";}", single);
+        assert(single["x"].desc == node->desc);
+        continue;
+      }
+      ++leaves;
+      FVV::Parser::ReadString("{x=" + value + desc + ";}", single);
+      assert(single["x"].value == node->value);
+      assert(single["x"].linkName == node->linkName);
+      assert(single["x"].desc == node->desc);
+    }
+    std::function<size_t(const FVV::FVVV &)> countLeaves;
+    countLeaves = [&countLeaves](const FVV::FVVV &node)
+    {
+      size_t count = 0;
+      for (const auto &[key, child] : node.children)
+        count += child.children.empty()
+                     ? (child.isNotEmpty() || !child.linkName.empty())
+                     : countLeaves(child);
+      return count;
+    };
+    assert(countLeaves(tree) == leaves);
+  }
+}
+
+static void testJsonScalars(void)
+{
+  const std::string fvv = FVV::Json::ToFVV(
+      std::string("{\"a\":1.5e-9,\"b\":1E22,\"c\":-7}"));
+  const FVV::FVVV root = parse(fvv);
+  assert(root.children.at("a").asDouble() == 1.5e-9);
+  assert(root.children.at("b").asDouble() == 1e22);
+  assert(root.children.at("c").asInt() == -7);
+  for (const char *json : {"{\"x\":12345678901}", "{\"x\":\"y\\\\\"}",
+                           "{\"x\":1e999}", "{\"x\":4.9e-324}"})
+  {
+    std::istringstream in(json);
+    std::ostringstream out;
+    assert(!FVV::Json::ToFVV(in, out));
+  }
+}
+
+static void testJsonValues(void)
+{
+  assert(FVV::Json::FromFVV(std::string("{a=\"x\" \"y\";}")) ==
+         "{\"a\":\"xy\"}");
+  for (const char *fvv : {"{a=1 \"y\";}", "{b=[1,[2]];}", "{a=;}",
+                          "{a=1,2;}", "{a=[,1];}"})
+  {
+    std::istringstream in(fvv);
+    std::ostringstream out;
+    assert(!FVV::Json::FromFVV(in, out));
+  }
+  for (const char *json : {"{\"x\":[1,1.5]}", "{\"x\":[true,1]}",
+                           "{\"x\":[1,\"y\"]}", "{\"x\":[null]}",
+                           "{\"x\":[]}"})
+  {
+    std::istringstream in(json);
+    std::ostringstream out;
+    assert(!FVV::Json::ToFVV(in, out));
+  }
+  FVV::Json::Options options;
+  options.expandLinks = true;
+  options.linkLimit = 8;
+  assert(FVV::Json::FromFVV(
+             std::string("{a=1; b=\"0123456789\"; c=a; d=b;}"), options) ==
+         "{\"a\":1,\"b\":\"0123456789\",\"c\":1,\"d\":{\"$ref\":\"b\"}}");
+}
+
+static void testPrintOptions(void)
+{
+  std::string txt = "{";
+  for (int i = 0; i < 32; ++i)
+    txt += "g" + std::to_string(i) + "={a=" + std::to_string(i) +
+           " <d>; l=[1.5,2]; s={t=\"x\";};}; v" + std::to_string(i) + "=1;";
+  txt += "}";
+  FVV::FVVV root = parse(txt);
+  FVV::Options parallel, cached;
+  parallel.threads = 8;
+  cached.cache = true;
+  for (const char *type : {"common", "min", "nodesc", "bigvec"})
+  {
+    const std::string expected = root.print(type);
+    assert(root.print(type, parallel) == expected);
+    assert(root.print(type, cached) == expected);
+    assert(root.print(type, cached) == expected);
+    cached.threads = 8;
+    assert(root.print(type, cached) == expected);
+    cached.threads = 1;
+  }
+  assert(root.memoryUsage().caches > 0);
+  root["g3"]["s"]["t"] = FVV::FVVV(std::string("y"));
+  root["g7"]["a"].setDesc("changed");
+  const std::string edited = root.print();
+  assert(edited.find("t = \"y\"") != std::string::npos);
+  assert(edited.find("<changed>") != std::string::npos);
+  assert(root.print("common", cached) == edited);
+  root.children["g5"].children["a"] = FVV::FVVV(99);
+  root.touch();
+  assert(root.print("common", cached) == root.print());
+  assert(root.print("common", cached).find("a = 99") != std::string::npos);
+}
+
+static bool hasTempFiles(const std::filesystem::path &dir)
+{
+  for (const auto &entry : std::filesystem::directory_iterator(dir))
+    if (entry.path().extension() == ".tmp")
+      return true;
+  return false;
+}
+
+static void testAsync(void)
+{
+  const std::filesystem::path dir = "fvv_async";
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directory(dir);
+  const std::string path = (dir / "doc.fvv").string();
+
+  FVV::Task<bool> save = FVV::saveAsync(path, parse("{a=1;b=\"x\";}"));
+  assert(save.get());
+  assert(readFile(path) == parse("{a=1;b=\"x\";}").print());
+  std::optional<FVV::FVVV> loaded = FVV::loadAsync(path).get();
+  assert(loaded && loaded->children.at("a").asInt() == 1);
+
+#if FVV_POSIX_IO
+  const auto mode = std::filesystem::perms::owner_read |
+                    std::filesystem::perms::owner_write |
+                    std::filesystem::perms::group_read;
+  std::filesystem::permissions(path, mode);
+  assert(FVV::saveAsync(path, parse("{a=2;}")).get());
+  assert((std::filesystem::status(path).permissions() &
+          std::filesystem::perms::mask) == mode);
+#endif
+
+  const std::string before = readFile(path);
+  std::stop_source source;
+  source.request_stop();
+  FVV::Options options;
+  options.stop = source.get_token();
+  assert(!FVV::saveAsync(path, parse("{a=3;}"), options).get());
+  assert(readFile(path) == before);
+  assert(!FVV::loadAsync(path, options).get());
+  assert(!FVV::saveAsync((dir / "missing" / "x.fvv").string(), parse("{a=1;}"))
+              .get());
+  assert(!hasTempFiles(dir));
+  std::filesystem::remove_all(dir);
+}
+
+static void testTouchAdoptsChildren(void)
+{
+  FVV::FVVV root = parse("{a=1;}");
+  root.children["x"] = FVV::FVVV(1);
+  root.touch();
+  const FVV::FVVV before = root;
+  const uint64_t hash = root.hash();
+  root.children["x"].setDesc("d");
+  assert(root.hash() != hash);
+  const FVV::Diff diff = FVV::FVVV::diff(before, root);
+  assert(diff.changed == std::vector<std::string>{"x"});
+}
+
+int main(void)
+{
+  testMemoryPolicy();
+  testMoveInvalidatesHash();
+  testTouchPastBlankNode();
+  testTouchAdoptsChildren();
+  testOverlay();
+  testDocumentReuse();
+  testDocumentEdits();
+  testScannerMatchesParser();
+  testJsonScalars();
+  testJsonValues();
+  testPrintOptions();
+  testAsync();
+  std::cout << "ok" << std::endl;
+  return 0;
+}